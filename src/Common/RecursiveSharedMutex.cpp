@@ -0,0 +1,141 @@
+// Copyright (c) 2017-2018 The TycheCash developers  ; Originally forked from Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "RecursiveSharedMutex.h"
+
+#include <cassert>
+#include <stdexcept>
+
+namespace Tools {
+
+namespace {
+
+const size_t WRITER_BIT = static_cast<size_t>(1) << (sizeof(size_t) * 8 - 1);
+
+// Recursion depths of the current thread, kept per mutex it owns.
+// Plain arrays keep thread local access free of initialization guards.
+struct Ownership {
+  const RecursiveSharedMutex* mutex;
+  size_t sharedDepth;
+  size_t exclusiveDepth;
+};
+
+const size_t MAX_OWNED_MUTEXES = 16;
+
+thread_local Ownership threadOwnerships[MAX_OWNED_MUTEXES];
+thread_local size_t threadOwnershipsCount = 0;
+
+Ownership& ownership(const RecursiveSharedMutex* mutex) {
+  for (size_t i = 0; i < threadOwnershipsCount; ++i) {
+    if (threadOwnerships[i].mutex == mutex) {
+      return threadOwnerships[i];
+    }
+  }
+
+  if (threadOwnershipsCount == MAX_OWNED_MUTEXES) {
+    throw std::runtime_error("RecursiveSharedMutex: too many mutexes owned by thread");
+  }
+
+  Ownership& entry = threadOwnerships[threadOwnershipsCount++];
+  entry.mutex = mutex;
+  entry.sharedDepth = 0;
+  entry.exclusiveDepth = 0;
+  return entry;
+}
+
+void releaseOwnership(const RecursiveSharedMutex* mutex) {
+  for (size_t i = 0; i < threadOwnershipsCount; ++i) {
+    if (threadOwnerships[i].mutex == mutex) {
+      if (threadOwnerships[i].sharedDepth == 0 && threadOwnerships[i].exclusiveDepth == 0) {
+        threadOwnerships[i] = threadOwnerships[--threadOwnershipsCount];
+      }
+
+      return;
+    }
+  }
+}
+
+}
+
+RecursiveSharedMutex::RecursiveSharedMutex() : m_state(0) {
+}
+
+void RecursiveSharedMutex::lock() {
+  Ownership& owner = ownership(this);
+  if (owner.exclusiveDepth != 0) {
+    ++owner.exclusiveDepth;
+    return;
+  }
+
+  assert(owner.sharedDepth == 0);
+
+  m_writerMutex.lock();
+  size_t state = m_state.fetch_or(WRITER_BIT);
+  if (state != 0) {
+    std::unique_lock<std::mutex> lk(m_drainMutex);
+    m_drainCondition.wait(lk, [this] { return m_state.load() == WRITER_BIT; });
+  }
+
+  owner.exclusiveDepth = 1;
+}
+
+void RecursiveSharedMutex::unlock() {
+  Ownership& owner = ownership(this);
+  assert(owner.exclusiveDepth != 0);
+  if (--owner.exclusiveDepth != 0) {
+    return;
+  }
+
+  releaseOwnership(this);
+  m_state.fetch_and(~WRITER_BIT);
+  m_writerMutex.unlock();
+}
+
+void RecursiveSharedMutex::lock_shared() {
+  Ownership& owner = ownership(this);
+  if (owner.exclusiveDepth != 0) {
+    ++owner.exclusiveDepth;
+    return;
+  }
+
+  // Already counted as reader, must not wait for a pending writer which in turn waits for this thread
+  if (owner.sharedDepth != 0) {
+    ++owner.sharedDepth;
+    return;
+  }
+
+  for (;;) {
+    size_t state = m_state.load();
+    while ((state & WRITER_BIT) == 0) {
+      if (m_state.compare_exchange_weak(state, state + 1)) {
+        owner.sharedDepth = 1;
+        return;
+      }
+    }
+
+    // Wait until the writer releases the lock
+    std::lock_guard<std::mutex> lk(m_writerMutex);
+  }
+}
+
+void RecursiveSharedMutex::unlock_shared() {
+  Ownership& owner = ownership(this);
+  if (owner.sharedDepth == 0) {
+    // Shared lock was taken while owning the lock exclusively
+    unlock();
+    return;
+  }
+
+  if (--owner.sharedDepth != 0) {
+    return;
+  }
+
+  releaseOwnership(this);
+  if (m_state.fetch_sub(1) == WRITER_BIT + 1) {
+    std::lock_guard<std::mutex> lk(m_drainMutex);
+    m_drainCondition.notify_one();
+  }
+}
+
+}
@@ -0,0 +1,57 @@
+// Copyright (c) 2017-2018 The TycheCash developers  ; Originally forked from Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+namespace Tools {
+
+// Reader/writer mutex with recursive ownership for both modes.
+// Writers are preferred: new readers wait while a writer is waiting, except threads which already hold the lock shared.
+// Thread holding the lock exclusively may also take it shared. Upgrading shared ownership to exclusive is not supported.
+// Uncontended shared locking costs a single atomic operation, nested locking does not touch shared state at all.
+class RecursiveSharedMutex {
+public:
+  RecursiveSharedMutex();
+
+  RecursiveSharedMutex(const RecursiveSharedMutex&) = delete;
+  RecursiveSharedMutex& operator=(const RecursiveSharedMutex&) = delete;
+
+  void lock();
+  void unlock();
+
+  void lock_shared();
+  void unlock_shared();
+
+private:
+  // Writer bit is set while a writer owns the lock or waits for readers to leave, remaining bits count readers
+  std::atomic<size_t> m_state;
+  // Held by the writer for the whole time of exclusive ownership
+  std::mutex m_writerMutex;
+  std::mutex m_drainMutex;
+  std::condition_variable m_drainCondition;
+};
+
+template<class Mutex> class SharedLockGuard {
+public:
+  explicit SharedLockGuard(Mutex& mutex) : m_mutex(mutex) {
+    m_mutex.lock_shared();
+  }
+
+  ~SharedLockGuard() {
+    m_mutex.unlock_shared();
+  }
+
+  SharedLockGuard(const SharedLockGuard&) = delete;
+  SharedLockGuard& operator=(const SharedLockGuard&) = delete;
+
+private:
+  Mutex& m_mutex;
+};
+
+}
@@ -0,0 +1,91 @@
+// Copyright (c) 2017-2018 The TycheCash developers  ; Originally forked from Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+namespace Tools {
+
+namespace {
+
+size_t effectiveThreadCount(size_t threadCount) {
+  if (threadCount == 0) {
+    threadCount = std::thread::hardware_concurrency();
+  }
+
+  return std::max<size_t>(threadCount, 1);
+}
+
+}
+
+ThreadPool::ThreadPool(size_t threadCount) :
+  m_tasks(effectiveThreadCount(threadCount)) {
+  for (size_t i = 1; i < effectiveThreadCount(threadCount); ++i) {
+    m_workers.emplace_back([this] {
+      std::function<void()> task;
+      while (m_tasks.pop(task)) {
+        task();
+      }
+    });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  m_tasks.close();
+  for (auto& worker : m_workers) {
+    worker.join();
+  }
+}
+
+size_t ThreadPool::threadCount() const {
+  return m_workers.size() + 1;
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& func) {
+  if (count == 0) {
+    return;
+  }
+
+  struct State {
+    std::atomic<size_t> next;
+    size_t activeHelpers;
+    std::mutex mutex;
+    std::condition_variable finished;
+  };
+
+  auto state = std::make_shared<State>();
+  state->next = 0;
+  const size_t helpers = std::min(m_workers.size(), count - 1);
+  state->activeHelpers = helpers;
+
+  auto run = [state, count, &func] {
+    for (size_t i = state->next++; i < count; i = state->next++) {
+      func(i);
+    }
+  };
+
+  for (size_t i = 0; i < helpers; ++i) {
+    m_tasks.push([state, run] {
+      run();
+
+      std::lock_guard<std::mutex> lk(state->mutex);
+      if (--state->activeHelpers == 0) {
+        state->finished.notify_one();
+      }
+    });
+  }
+
+  run();
+
+  // func is captured by reference, so helpers must be finished before returning even if there is no work left for them
+  std::unique_lock<std::mutex> lk(state->mutex);
+  state->finished.wait(lk, [&state] { return state->activeHelpers == 0; });
+}
+
+}
@@ -0,0 +1,37 @@
+// Copyright (c) 2017-2018 The TycheCash developers  ; Originally forked from Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "BlockingQueue.h"
+
+namespace Tools {
+
+class ThreadPool {
+public:
+  // Starts threadCount - 1 worker threads, the thread calling parallelFor does its share of work as well.
+  // Zero means number of hardware threads.
+  explicit ThreadPool(size_t threadCount);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  size_t threadCount() const;
+
+  // Calls func(i) for every i in [0, count) and returns when all calls are completed.
+  // func must not throw and must not call parallelFor of the same pool.
+  void parallelFor(size_t count, const std::function<void(size_t)>& func);
+
+private:
+  BlockingQueue<std::function<void()>> m_tasks;
+  std::vector<std::thread> m_workers;
+};
+
+}
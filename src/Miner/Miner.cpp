@@ -63,11 +63,21 @@ void Miner::runWorkers(BlockMiningParameters blockMiningParameters, size_t threa
   m_logger(Logging::INFO) << "Starting mining for difficulty " << blockMiningParameters.difficulty;
 
   try {
+    const size_t contextsCount = threadCount * Crypto::cn_slow_hash_preferred_ways();
+    if (m_cryptoContexts.size() < contextsCount) {
+      while (m_cryptoContexts.size() < contextsCount) {
+        m_cryptoContexts.emplace_back(new Crypto::cn_context());
+      }
+
+      m_logger(Logging::INFO) << "Allocated " << contextsCount << " mining scratchpads, they use " <<
+        Crypto::cn_context::pageModeName(m_cryptoContexts.back()->pageMode());
+    }
+
     blockMiningParameters.blockTemplate.nonce = Crypto::rand<uint32_t>();
 
     for (size_t i = 0; i < threadCount; ++i) {
       m_workers.emplace_back(std::unique_ptr<System::RemoteContext<void>> (
-        new System::RemoteContext<void>(m_dispatcher, std::bind(&Miner::workerFunc, this, blockMiningParameters.blockTemplate, blockMiningParameters.difficulty, threadCount)))
+        new System::RemoteContext<void>(m_dispatcher, std::bind(&Miner::workerFunc, this, blockMiningParameters.blockTemplate, blockMiningParameters.difficulty, threadCount, i)))
       );
 
       blockMiningParameters.blockTemplate.nonce++;
@@ -83,33 +93,43 @@ void Miner::runWorkers(BlockMiningParameters blockMiningParameters, size_t threa
   m_miningStopped.set();
 }
 
-void Miner::workerFunc(const Block& blockTemplate, difficulty_type difficulty, uint32_t nonceStep) {
+void Miner::workerFunc(const Block& blockTemplate, difficulty_type difficulty, uint32_t nonceStep, size_t workerIndex) {
   try {
-    Block block = blockTemplate;
-    Crypto::cn_context cryptoContext;
+    // several nonces are hashed at once, every one of them with its own context
+    const size_t ways = Crypto::cn_slow_hash_preferred_ways();
+    std::vector<Crypto::cn_context*> contextPointers;
+    std::vector<Block> blocks(ways, blockTemplate);
+    for (size_t i = 0; i < ways; ++i) {
+      contextPointers.push_back(m_cryptoContexts[workerIndex * ways + i].get());
+      blocks[i].nonce = blockTemplate.nonce + static_cast<uint32_t>(i) * nonceStep;
+    }
 
+    std::vector<Crypto::Hash> hashes(ways);
     while (m_state == MiningState::MINING_IN_PROGRESS) {
-      Crypto::Hash hash;
-      if (!get_block_longhash(cryptoContext, block, hash)) {
+      if (!get_block_longhashes(contextPointers.data(), blocks.data(), ways, hashes.data())) {
         //error occured
         m_logger(Logging::DEBUGGING) << "calculating long hash error occured";
         m_state = MiningState::MINING_STOPPED;
         return;
       }
 
-      if (check_hash(hash, difficulty)) {
-        m_logger(Logging::INFO) << "Found block for difficulty " << difficulty;
+      for (size_t i = 0; i < ways; ++i) {
+        if (check_hash(hashes[i], difficulty)) {
+          m_logger(Logging::INFO) << "Found block for difficulty " << difficulty;
 
-        if (!setStateBlockFound()) {
-          m_logger(Logging::DEBUGGING) << "block is already found or mining stopped";
+          if (!setStateBlockFound()) {
+            m_logger(Logging::DEBUGGING) << "block is already found or mining stopped";
+            return;
+          }
+
+          m_block = blocks[i];
           return;
         }
-
-        m_block = block;
-        return;
       }
 
-      block.nonce += nonceStep;
+      for (Block& block : blocks) {
+        block.nonce += static_cast<uint32_t>(ways) * nonceStep;
+      }
     }
   } catch (std::exception& e) {
     m_logger(Logging::ERROR) << "Miner got error: " << e.what();
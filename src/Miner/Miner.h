@@ -13,6 +13,7 @@
 
 #include "TycheCash.h"
 #include "TycheCashCore/Difficulty.h"
+#include "crypto/hash.h"
 
 #include "Logging/LoggerRef.h"
 
@@ -44,10 +45,13 @@ private:
 
   Block m_block;
 
+  // Scratchpads are kept between blocks, worker i uses contexts [i * ways, (i + 1) * ways)
+  std::vector<std::unique_ptr<Crypto::cn_context>> m_cryptoContexts;
+
   Logging::LoggerRef m_logger;
 
   void runWorkers(BlockMiningParameters blockMiningParameters, size_t threadCount);
-  void workerFunc(const Block& blockTemplate, difficulty_type difficulty, uint32_t nonceStep);
+  void workerFunc(const Block& blockTemplate, difficulty_type difficulty, uint32_t nonceStep, size_t workerIndex);
   bool setStateBlockFound();
 };
 
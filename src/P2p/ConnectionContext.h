@@ -11,6 +11,8 @@
 #include <boost/uuid/uuid.hpp>
 #include "Common/StringTools.h"
 #include "crypto/hash.h"
+#include "TycheCashConfig.h"
+#include "TycheCashProtocol/TransactionInventory.h"
 
 namespace TycheCash {
 
@@ -37,6 +39,7 @@ struct TycheCashConnectionContext {
   std::unordered_set<Crypto::Hash> m_requested_objects;
   uint32_t m_remote_blockchain_height = 0;
   uint32_t m_last_response_height = 0;
+  KnownInventory m_knownTransactions = KnownInventory(P2P_KNOWN_TRANSACTIONS_MAX_COUNT);
 };
 
 inline std::string get_protocol_state_string(TycheCashConnectionContext::state s) {
@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "LevinProtocol.h"
+#include <Common/StreamTools.h>
 #include <System/TcpConnection.h>
 
 using namespace TycheCash;
@@ -29,8 +30,12 @@ struct bucket_head2
 };
 #pragma pack(pop)
 
+static_assert(sizeof(bucket_head2) == 33, "Unexpected Levin header size");
+
 }
 
+const size_t LevinProtocol::HEADER_SIZE;
+
 bool LevinProtocol::Command::needReply() const {
   return !(isNotify || isResponse);
 }
@@ -39,23 +44,9 @@ LevinProtocol::LevinProtocol(System::TcpConnection& connection)
   : m_conn(connection) {}
 
 void LevinProtocol::sendMessage(uint32_t command, const BinaryArray& out, bool needResponse) {
-  bucket_head2 head = { 0 };
-  head.m_signature = LEVIN_SIGNATURE;
-  head.m_cb = out.size();
-  head.m_have_to_return_data = needResponse;
-  head.m_command = command;
-  head.m_protocol_version = LEVIN_PROTOCOL_VER_1;
-  head.m_flags = LEVIN_PACKET_REQUEST;
-
   // write header and body in one operation
-  BinaryArray writeBuffer;
-  writeBuffer.reserve(sizeof(head) + out.size());
-
-  Common::VectorOutputStream stream(writeBuffer);
-  stream.writeSome(&head, sizeof(head));
-  stream.writeSome(out.data(), out.size());
-
-  writeStrict(writeBuffer.data(), writeBuffer.size());
+  BinaryArray packet = makePacket(command, out, needResponse);
+  writeStrict(packet.data(), packet.size());
 }
 
 bool LevinProtocol::readCommand(Command& cmd) {
@@ -91,23 +82,69 @@ bool LevinProtocol::readCommand(Command& cmd) {
 }
 
 void LevinProtocol::sendReply(uint32_t command, const BinaryArray& out, int32_t returnCode) {
+  BinaryArray packet = makeReplyPacket(command, out, returnCode);
+  writeStrict(packet.data(), packet.size());
+}
+
+void LevinProtocol::sendPackets(const std::vector<const BinaryArray*>& packets) {
+  std::vector<System::TcpConnection::Buffer> buffers;
+  buffers.reserve(packets.size());
+  for (auto packet : packets) {
+    if (!packet->empty()) {
+      buffers.push_back({ packet->data(), packet->size() });
+    }
+  }
+
+  size_t first = 0;
+  while (first < buffers.size()) {
+    size_t written = m_conn.writeBuffers(&buffers[first], buffers.size() - first);
+
+    // drop what has been written, the rest goes in the next call
+    while (written > 0) {
+      auto& buffer = buffers[first];
+      if (written < buffer.size) {
+        buffer.data += written;
+        buffer.size -= written;
+        break;
+      }
+
+      written -= buffer.size;
+      ++first;
+    }
+  }
+}
+
+BinaryArray LevinProtocol::makePacket(uint32_t command, const BinaryArray& out, bool needResponse) {
+  BinaryArray packet;
+  packet.reserve(HEADER_SIZE + out.size());
+
+  Common::VectorOutputStream stream(packet);
+  writeHeader(stream, command, out.size(), needResponse, false, 0);
+  Common::write(stream, out.data(), out.size());
+  return packet;
+}
+
+BinaryArray LevinProtocol::makeReplyPacket(uint32_t command, const BinaryArray& out, int32_t returnCode) {
+  BinaryArray packet;
+  packet.reserve(HEADER_SIZE + out.size());
+
+  Common::VectorOutputStream stream(packet);
+  writeHeader(stream, command, out.size(), false, true, returnCode);
+  Common::write(stream, out.data(), out.size());
+  return packet;
+}
+
+void LevinProtocol::writeHeader(Common::IOutputStream& stream, uint32_t command, uint64_t bodySize, bool needResponse, bool isResponse, int32_t returnCode) {
   bucket_head2 head = { 0 };
   head.m_signature = LEVIN_SIGNATURE;
-  head.m_cb = out.size();
-  head.m_have_to_return_data = false;
+  head.m_cb = bodySize;
+  head.m_have_to_return_data = needResponse;
   head.m_command = command;
   head.m_protocol_version = LEVIN_PROTOCOL_VER_1;
-  head.m_flags = LEVIN_PACKET_RESPONSE;
+  head.m_flags = isResponse ? LEVIN_PACKET_RESPONSE : LEVIN_PACKET_REQUEST;
   head.m_return_code = returnCode;
 
-  BinaryArray writeBuffer;
-  writeBuffer.reserve(sizeof(head) + out.size());
-
-  Common::VectorOutputStream stream(writeBuffer);
-  stream.writeSome(&head, sizeof(head));
-  stream.writeSome(out.data(), out.size());
-
-  writeStrict(writeBuffer.data(), writeBuffer.size());
+  Common::write(stream, &head, sizeof(head));
 }
 
 void LevinProtocol::writeStrict(const uint8_t* ptr, size_t size) {
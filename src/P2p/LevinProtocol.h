@@ -36,7 +36,8 @@ public:
 
   template <typename Request, typename Response>
   bool invoke(uint32_t command, const Request& request, Response& response) {
-    sendMessage(command, encode(request), true);
+    BinaryArray packet = encodePacket(command, request, true);
+    writeStrict(packet.data(), packet.size());
 
     Command cmd;
     readCommand(cmd);
@@ -50,7 +51,8 @@ public:
 
   template <typename Request>
   void notify(uint32_t command, const Request& request, int) {
-    sendMessage(command, encode(request), false);
+    BinaryArray packet = encodePacket(command, request, false);
+    writeStrict(packet.data(), packet.size());
   }
 
   struct Command {
@@ -66,6 +68,12 @@ public:
 
   void sendMessage(uint32_t command, const BinaryArray& out, bool needResponse);
   void sendReply(uint32_t command, const BinaryArray& out, int32_t returnCode);
+  // Writes complete packets, made by makePacket, makeReplyPacket or encodePacket, with as few system calls as possible
+  void sendPackets(const std::vector<const BinaryArray*>& packets);
+
+  // Complete packet, header and body, which can be sent to any number of connections as is
+  static BinaryArray makePacket(uint32_t command, const BinaryArray& out, bool needResponse);
+  static BinaryArray makeReplyPacket(uint32_t command, const BinaryArray& out, int32_t returnCode);
 
   template <typename T>
   static bool decode(const BinaryArray& buf, T& value) {
@@ -85,13 +93,32 @@ public:
     BinaryArray result;
     KVBinaryOutputStreamSerializer serializer;
     serialize(const_cast<T&>(value), serializer);
+    result.reserve(serializer.dumpSize());
+    Common::VectorOutputStream stream(result);
+    serializer.dump(stream);
+    return result;
+  }
+
+  // Serializes the value right behind the packet header, without an intermediate body buffer
+  template <typename T>
+  static BinaryArray encodePacket(uint32_t command, const T& value, bool needResponse) {
+    BinaryArray result;
+    KVBinaryOutputStreamSerializer serializer;
+    serialize(const_cast<T&>(value), serializer);
+    size_t bodySize = serializer.dumpSize();
+    result.reserve(HEADER_SIZE + bodySize);
     Common::VectorOutputStream stream(result);
+    writeHeader(stream, command, bodySize, needResponse, false, 0);
     serializer.dump(stream);
     return result;
   }
 
 private:
 
+  static const size_t HEADER_SIZE = 33;
+
+  static void writeHeader(Common::IOutputStream& stream, uint32_t command, uint64_t bodySize, bool needResponse, bool isResponse, int32_t returnCode);
+
   bool readStrict(uint8_t* ptr, size_t size);
   void writeStrict(const uint8_t* ptr, size_t size);
   System::TcpConnection& m_conn;
@@ -122,6 +122,18 @@ namespace TycheCash
   }
 
 
+  //-----------------------------------------------------------------------------------
+  // P2pMessage implementation
+  //-----------------------------------------------------------------------------------
+
+  P2pMessage::P2pMessage(Type type, uint32_t command, const BinaryArray& buffer, int32_t returnCode) :
+    type(type),
+    command(command),
+    packet(std::make_shared<BinaryArray>(type == REPLY ?
+      LevinProtocol::makeReplyPacket(command, buffer, returnCode) :
+      LevinProtocol::makePacket(command, buffer, type == COMMAND))) {
+  }
+
   //-----------------------------------------------------------------------------------
   // P2pConnectionContext implementation
   //-----------------------------------------------------------------------------------
@@ -602,13 +614,13 @@ namespace TycheCash
   bool NodeServer::timedSync() {
     COMMAND_TIMED_SYNC::request arg = boost::value_initialized<COMMAND_TIMED_SYNC::request>();
     m_payload_handler.get_payload_sync_data(arg.payload_data);
-    auto cmdBuf = LevinProtocol::encode<COMMAND_TIMED_SYNC::request>(arg);
+    std::shared_ptr<const BinaryArray> packet = std::make_shared<BinaryArray>(LevinProtocol::encodePacket(COMMAND_TIMED_SYNC::ID, arg, true));
 
     forEachConnection([&](P2pConnectionContext& conn) {
       if (conn.peerId && 
           (conn.m_state == TycheCashConnectionContext::state_normal || 
            conn.m_state == TycheCashConnectionContext::state_idle)) {
-        conn.pushMessage(P2pMessage(P2pMessage::COMMAND, COMMAND_TIMED_SYNC::ID, cmdBuf));
+        conn.pushMessage(P2pMessage(P2pMessage::COMMAND, COMMAND_TIMED_SYNC::ID, packet));
       }
     });
 
@@ -1038,12 +1050,18 @@ namespace TycheCash
   
   void NodeServer::relay_notify_to_all(int command, const BinaryArray& data_buff, const net_connection_id* excludeConnection) {
     net_connection_id excludeId = excludeConnection ? *excludeConnection : boost::value_initialized<net_connection_id>();
+    // the packet is built once and shared by all connections
+    std::shared_ptr<const BinaryArray> packet;
 
     forEachConnection([&](P2pConnectionContext& conn) {
       if (conn.peerId && conn.m_connection_id != excludeId &&
           (conn.m_state == TycheCashConnectionContext::state_normal ||
            conn.m_state == TycheCashConnectionContext::state_synchronizing)) {
-        conn.pushMessage(P2pMessage(P2pMessage::NOTIFY, command, data_buff));
+        if (!packet) {
+          packet = std::make_shared<BinaryArray>(LevinProtocol::makePacket(command, data_buff, false));
+        }
+
+        conn.pushMessage(P2pMessage(P2pMessage::NOTIFY, command, packet));
       }
     });
   }
@@ -1427,22 +1445,14 @@ namespace TycheCash
           break;
         }
 
+        std::vector<const BinaryArray*> packets;
+        packets.reserve(msgs.size());
         for (const auto& msg : msgs) {
           logger(DEBUGGING) << ctx << "msg " << msg.type << ':' << msg.command;
-          switch (msg.type) {
-          case P2pMessage::COMMAND:
-            proto.sendMessage(msg.command, msg.buffer, true);
-            break;
-          case P2pMessage::NOTIFY:
-            proto.sendMessage(msg.command, msg.buffer, false);
-            break;
-          case P2pMessage::REPLY:
-            proto.sendReply(msg.command, msg.buffer, msg.returnCode);
-            break;
-          default:
-            assert(false);
-          }
+          packets.push_back(msg.packet.get());
         }
+
+        proto.sendPackets(packets);
       }
     } catch (System::InterruptedException&) {
       // connection stopped
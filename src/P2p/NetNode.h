@@ -5,6 +5,7 @@
 #pragma once
 
 #include <functional>
+#include <memory>
 #include <unordered_map>
 
 #include <boost/functional/hash.hpp>
@@ -46,22 +47,24 @@ namespace TycheCash
       NOTIFY
     };
 
-    P2pMessage(Type type, uint32_t command, const BinaryArray& buffer, int32_t returnCode = 0) :
-      type(type), command(command), buffer(buffer), returnCode(returnCode) {
+    P2pMessage(Type type, uint32_t command, const BinaryArray& buffer, int32_t returnCode = 0);
+
+    // Packet made by LevinProtocol, shared by all connections it is sent to
+    P2pMessage(Type type, uint32_t command, std::shared_ptr<const BinaryArray> packet) :
+      type(type), command(command), packet(std::move(packet)) {
     }
 
     P2pMessage(P2pMessage&& msg) :
-      type(msg.type), command(msg.command), buffer(std::move(msg.buffer)), returnCode(msg.returnCode) {
+      type(msg.type), command(msg.command), packet(std::move(msg.packet)) {
     }
 
     size_t size() {
-      return buffer.size();
+      return packet->size();
     }
 
     Type type;
     uint32_t command;
-    const BinaryArray buffer;
-    int32_t returnCode;
+    std::shared_ptr<const BinaryArray> packet;
   };
 
   struct P2pConnectionContext : public TycheCashConnectionContext {
@@ -42,7 +42,8 @@ namespace TycheCash
   enum P2PProtocolVersion : uint8_t {
     V0 = 0,
     V1 = 1,
-    CURRENT = V1
+    V2 = 2, // transactions are announced with NOTIFY_TX_INVENTORY and fetched on demand
+    CURRENT = V2
   };
 
   struct basic_node_data
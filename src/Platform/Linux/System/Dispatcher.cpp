@@ -4,7 +4,12 @@
 
 #include "Dispatcher.h"
 #include <cassert>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <thread>
 
+#include <poll.h>
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
 #include <sys/timerfd.h>
@@ -16,6 +21,22 @@
 
 namespace System {
 
+struct Dispatcher::ThreadState {
+  Dispatcher* dispatcher;
+  NativeContext* currentContext;
+  // context the thread switches to when it has nothing to run, it processes events and steals contexts of other threads
+  NativeContext idleContext;
+  uint8_t* idleStack;
+  std::deque<NativeContext*> runQueue;
+  // main context ready to be resumed, only the thread which created the dispatcher uses it
+  NativeContext* pinnedContext;
+  // an idle thread waits for it along with the epoll, so that it is woken even if another thread processes the events
+  int wakeEvent;
+  bool idle;
+  bool wakePending;
+  std::thread thread;
+};
+
 namespace {
 
 struct ContextMakingData {
@@ -44,9 +65,30 @@ static_assert(Dispatcher::SIZEOF_PTHREAD_MUTEX_T == sizeof(pthread_mutex_t), "in
 
 const size_t STACK_SIZE = 64 * 1024;
 
+size_t defaultThreadCount = 1;
+
+// Dispatchers the current thread runs contexts of, a thread is bound to a dispatcher while it runs its contexts
+thread_local std::vector<std::pair<const Dispatcher*, void*>> threadBindings;
+
+void bindThread(const Dispatcher* dispatcher, void* thread) {
+  threadBindings.emplace_back(dispatcher, thread);
+}
+
+void unbindThread(const Dispatcher* dispatcher) {
+  for (auto it = threadBindings.begin(); it != threadBindings.end(); ++it) {
+    if (it->first == dispatcher) {
+      threadBindings.erase(it);
+      break;
+    }
+  }
+}
+
 };
 
-Dispatcher::Dispatcher() {
+Dispatcher::Dispatcher() : Dispatcher(defaultThreadCount) {
+}
+
+Dispatcher::Dispatcher(size_t threadCount) : stateLock(false), idleThreadCount(0), stopping(false) {
   std::string message;
   epoll = ::epoll_create1(0);
   if (epoll == -1) {
@@ -84,7 +126,25 @@ Dispatcher::Dispatcher() {
           firstResumingContext = nullptr;
           firstReusableContext = nullptr;
           runningContextCount = 0;
-          return;
+          if (threadCount <= 1) {
+            return;
+          }
+
+          try {
+            startThreads(threadCount);
+            return;
+          } catch (std::exception& e) {
+            message = e.what();
+          }
+
+          for (auto& thread : threads) {
+            if (thread->wakeEvent != -1) {
+              auto result = close(thread->wakeEvent);
+              assert(result == 0);
+            }
+          }
+
+          threads.clear();
         }
 
         auto result = close(remoteSpawnEvent);
@@ -100,11 +160,16 @@ Dispatcher::Dispatcher() {
 }
 
 Dispatcher::~Dispatcher() {
-  for (NativeContext* context = contextGroup.firstContext; context != nullptr; context = context->groupNext) {
-    interrupt(context);
+  if (!threads.empty()) {
+    stopThreads();
+  } else {
+    for (NativeContext* context = contextGroup.firstContext; context != nullptr; context = context->groupNext) {
+      interrupt(context);
+    }
+
+    yield();
   }
 
-  yield();
   assert(contextGroup.firstContext == nullptr);
   assert(contextGroup.firstWaiter == nullptr);
   assert(firstResumingContext == nullptr);
@@ -132,6 +197,7 @@ Dispatcher::~Dispatcher() {
 }
 
 void Dispatcher::clear() {
+  std::lock_guard<Dispatcher> guard(*this);
   while (firstReusableContext != nullptr) {
     auto ucontext = static_cast<ucontext_t*>(firstReusableContext->ucontext);
     auto stackPtr = static_cast<uint8_t *>(firstReusableContext->stackPtr);
@@ -151,6 +217,25 @@ void Dispatcher::clear() {
 }
 
 void Dispatcher::dispatch() {
+  if (!threads.empty()) {
+    // never blocks on a context stack: when there is nothing to run the thread switches to its idle context
+    ThreadState* thread = currentThread();
+    NativeContext* context = takeContext(*thread);
+    if (context == nullptr) {
+      context = &thread->idleContext;
+    }
+
+    if (context != thread->currentContext) {
+      ucontext_t* oldContext = static_cast<ucontext_t*>(thread->currentContext->ucontext);
+      thread->currentContext = context;
+      if (swapcontext(oldContext, static_cast<ucontext_t *>(context->ucontext)) == -1) {
+        throw std::runtime_error("Dispatcher::dispatch, swapcontext failed, " + lastErrorMessage());
+      }
+    }
+
+    return;
+  }
+
   NativeContext* context;
   for (;;) {
     if (firstResumingContext != nullptr) {
@@ -208,11 +293,15 @@ void Dispatcher::dispatch() {
 }
 
 NativeContext* Dispatcher::getCurrentContext() const {
+  if (!threads.empty()) {
+    return currentThread()->currentContext;
+  }
+
   return currentContext;
 }
 
 void Dispatcher::interrupt() {
-  interrupt(currentContext);
+  interrupt(getCurrentContext());
 }
 
 void Dispatcher::interrupt(NativeContext* context) {
@@ -228,8 +317,9 @@ void Dispatcher::interrupt(NativeContext* context) {
 }
 
 bool Dispatcher::interrupted() {
-  if (currentContext->interrupted) {
-    currentContext->interrupted = false;
+  NativeContext* context = getCurrentContext();
+  if (context->interrupted) {
+    context->interrupted = false;
     return true;
   }
 
@@ -238,6 +328,27 @@ bool Dispatcher::interrupted() {
 
 void Dispatcher::pushContext(NativeContext* context) {
   assert(context != nullptr);
+  if (!threads.empty()) {
+    ThreadState* thread = currentThread();
+    if (context == &mainContext) {
+      threads.front()->pinnedContext = context;
+      wakeThread(*threads.front());
+    } else {
+      thread->runQueue.push_back(context);
+      // a thread running a context cannot pick up the pushed one soon, let an idle thread steal it
+      if (idleThreadCount > 0 && (thread->currentContext != &thread->idleContext || thread->runQueue.size() > 1)) {
+        for (auto& idleThread : threads) {
+          if (idleThread->idle && !idleThread->wakePending) {
+            wakeThread(*idleThread);
+            break;
+          }
+        }
+      }
+    }
+
+    return;
+  }
+
   context->next = nullptr;
   if(firstResumingContext != nullptr) {
     assert(lastResumingContext != nullptr);
@@ -282,6 +393,36 @@ void Dispatcher::spawn(std::function<void()>&& procedure) {
 }
 
 void Dispatcher::yield() {
+  std::lock_guard<Dispatcher> guard(*this);
+  processEvents();
+  if (hasResumingContexts()) {
+    pushContext(getCurrentContext());
+    dispatch();
+  }
+}
+
+void Dispatcher::lock() {
+  if (!threads.empty()) {
+    while (stateLock.exchange(true, std::memory_order_acquire)) {
+      while (stateLock.load(std::memory_order_relaxed)) {
+        std::this_thread::yield();
+      }
+    }
+  }
+}
+
+void Dispatcher::unlock() {
+  if (!threads.empty()) {
+    stateLock.store(false, std::memory_order_release);
+  }
+}
+
+void Dispatcher::setDefaultThreadCount(size_t threadCount) {
+  assert(threadCount > 0);
+  defaultThreadCount = threadCount;
+}
+
+void Dispatcher::processEvents() {
   for(;;){
     epoll_event events[16];
     int count = epoll_wait(epoll, events, 16, 0);
@@ -326,11 +467,201 @@ void Dispatcher::yield() {
       }
     }
   }
+}
 
-  if (firstResumingContext != nullptr) {
-    pushContext(currentContext);
-    dispatch();
+bool Dispatcher::hasResumingContexts() {
+  if (!threads.empty()) {
+    ThreadState* thread = currentThread();
+    return !thread->runQueue.empty() || (thread == threads.front().get() && thread->pinnedContext != nullptr);
   }
+
+  return firstResumingContext != nullptr;
+}
+
+NativeContext* Dispatcher::takeContext(ThreadState& thread) {
+  NativeContext* context;
+  // the main context goes first, so that a thread yielding in a loop does not keep it waiting
+  if (thread.pinnedContext != nullptr) {
+    context = thread.pinnedContext;
+    thread.pinnedContext = nullptr;
+    return context;
+  }
+
+  if (!thread.runQueue.empty()) {
+    context = thread.runQueue.front();
+    thread.runQueue.pop_front();
+    return context;
+  }
+
+  // steal the most recently pushed context, the owner thread is going to run its oldest ones first
+  for (auto& victim : threads) {
+    if (!victim->runQueue.empty()) {
+      context = victim->runQueue.back();
+      victim->runQueue.pop_back();
+      return context;
+    }
+  }
+
+  return nullptr;
+}
+
+__attribute__((noinline)) Dispatcher::ThreadState* Dispatcher::currentThread() const {
+  // not inlined: a context may be resumed on another thread, so the thread local storage address must not be cached across switches
+  for (auto& binding : threadBindings) {
+    if (binding.first == this) {
+      return static_cast<ThreadState*>(binding.second);
+    }
+  }
+
+  assert(false);
+  throw std::runtime_error("Dispatcher::currentThread, dispatcher is used from a thread it does not run on");
+}
+
+void Dispatcher::wakeThread(ThreadState& thread) {
+  if (thread.idle && !thread.wakePending) {
+    uint64_t one = 1;
+    if (write(thread.wakeEvent, &one, sizeof one) == -1) {
+      throw std::runtime_error("Dispatcher::wakeThread, write failed, " + lastErrorMessage());
+    }
+
+    thread.wakePending = true;
+  }
+}
+
+void Dispatcher::runThread(ThreadState& thread) {
+  for (;;) {
+    if (stopping) {
+      return;
+    }
+
+    processEvents();
+    NativeContext* context = takeContext(thread);
+    if (context != nullptr) {
+      thread.currentContext = context;
+      if (swapcontext(static_cast<ucontext_t*>(thread.idleContext.ucontext), static_cast<ucontext_t*>(context->ucontext)) == -1) {
+        throw std::runtime_error("Dispatcher::runThread, swapcontext failed, " + lastErrorMessage());
+      }
+
+      continue;
+    }
+
+    thread.idle = true;
+    ++idleThreadCount;
+    unlock();
+    pollfd events[2];
+    events[0].fd = epoll;
+    events[0].events = POLLIN;
+    events[1].fd = thread.wakeEvent;
+    events[1].events = POLLIN;
+    int result = poll(events, 2, -1);
+    lock();
+    thread.idle = false;
+    --idleThreadCount;
+    if (result == -1 && errno != EINTR) {
+      throw std::runtime_error("Dispatcher::runThread, poll failed, " + lastErrorMessage());
+    }
+
+    if (thread.wakePending) {
+      uint64_t buf;
+      if (read(thread.wakeEvent, &buf, sizeof buf) == -1 && errno != EAGAIN) {
+        throw std::runtime_error("Dispatcher::runThread, read failed, " + lastErrorMessage());
+      }
+
+      thread.wakePending = false;
+    }
+  }
+}
+
+void Dispatcher::startThreads(size_t threadCount) {
+  for (size_t i = 0; i < threadCount; ++i) {
+    std::unique_ptr<ThreadState> thread(new ThreadState);
+    thread->dispatcher = this;
+    thread->currentContext = &thread->idleContext;
+    thread->idleContext.ucontext = nullptr;
+    thread->idleContext.interrupted = false;
+    thread->idleContext.group = nullptr;
+    thread->idleStack = nullptr;
+    thread->pinnedContext = nullptr;
+    thread->idle = false;
+    thread->wakePending = false;
+    thread->wakeEvent = eventfd(0, O_NONBLOCK);
+    threads.push_back(std::move(thread));
+    if (threads.back()->wakeEvent == -1) {
+      throw std::runtime_error("eventfd failed, " + lastErrorMessage());
+    }
+  }
+
+  // the calling thread runs its idle context on a separate stack, as its own one belongs to the main context
+  ThreadState& mainThread = *threads.front();
+  mainThread.currentContext = &mainContext;
+  ucontext_t* idleContext = new ucontext_t;
+  if (getcontext(idleContext) == -1) {
+    delete idleContext;
+    throw std::runtime_error("getcontext failed, " + lastErrorMessage());
+  }
+
+  mainThread.idleStack = new uint8_t[STACK_SIZE];
+  idleContext->uc_stack.ss_sp = mainThread.idleStack;
+  idleContext->uc_stack.ss_size = STACK_SIZE;
+  idleContext->uc_link = nullptr;
+  makecontext(idleContext, (void(*)())idleProcedureStatic, 1, reinterpret_cast<int*>(&mainThread));
+  mainThread.idleContext.ucontext = idleContext;
+  bindThread(this, &mainThread);
+
+  for (size_t i = 1; i < threads.size(); ++i) {
+    ThreadState* thread = threads[i].get();
+    thread->thread = std::thread([this, thread] {
+      bindThread(this, thread);
+      ucontext_t idleContext;
+      thread->idleContext.ucontext = &idleContext;
+      lock();
+      runThread(*thread);
+      unlock();
+      unbindThread(this);
+    });
+  }
+}
+
+void Dispatcher::stopThreads() {
+  {
+    std::lock_guard<Dispatcher> guard(*this);
+    for (NativeContext* context = contextGroup.firstContext; context != nullptr; context = context->groupNext) {
+      interrupt(context);
+    }
+  }
+
+  // interrupted contexts may be running or waiting on other threads
+  for (;;) {
+    yield();
+    std::lock_guard<Dispatcher> guard(*this);
+    if (contextGroup.firstContext == nullptr && runningContextCount == 0) {
+      break;
+    }
+  }
+
+  {
+    std::lock_guard<Dispatcher> guard(*this);
+    stopping = true;
+    for (auto& thread : threads) {
+      wakeThread(*thread);
+    }
+  }
+
+  for (size_t i = 1; i < threads.size(); ++i) {
+    threads[i]->thread.join();
+  }
+
+  ThreadState& mainThread = *threads.front();
+  assert(mainThread.runQueue.empty() && mainThread.pinnedContext == nullptr);
+  delete static_cast<ucontext_t*>(mainThread.idleContext.ucontext);
+  delete[] mainThread.idleStack;
+  unbindThread(this);
+  for (auto& thread : threads) {
+    auto result = close(thread->wakeEvent);
+    assert(result == 0);
+  }
+
+  threads.clear();
 }
 
 int Dispatcher::getEpoll() const {
@@ -351,7 +682,7 @@ NativeContext& Dispatcher::getReusableContext() {
     ContextMakingData makingContextData {this, newlyCreatedContext};
     makecontext(newlyCreatedContext, (void(*)())contextProcedureStatic, 1, reinterpret_cast<int*>(&makingContextData));
 
-    ucontext_t* oldContext = static_cast<ucontext_t*>(currentContext->ucontext);
+    ucontext_t* oldContext = static_cast<ucontext_t*>(getCurrentContext()->ucontext);
     if (swapcontext(oldContext, newlyCreatedContext) == -1) {
       throw std::runtime_error("Dispatcher::getReusableContext, swapcontext failed, " + lastErrorMessage());
     }
@@ -403,17 +734,21 @@ void Dispatcher::contextProcedure(void* ucontext) {
   context.next = nullptr;
   firstReusableContext = &context;
   ucontext_t* oldContext = static_cast<ucontext_t*>(context.ucontext);
-  if (swapcontext(oldContext, static_cast<ucontext_t*>(currentContext->ucontext)) == -1) {
+  if (swapcontext(oldContext, static_cast<ucontext_t*>(getCurrentContext()->ucontext)) == -1) {
     throw std::runtime_error("Dispatcher::contextProcedure, swapcontext failed, " + lastErrorMessage());
   }
 
   for (;;) {
     ++runningContextCount;
+    // the context was resumed by a switch made under the lock
+    unlock();
     try {
       context.procedure();
     } catch(std::exception&) {
     }
 
+    lock();
+
     if (context.group != nullptr) {
       if (context.groupPrev != nullptr) {
         assert(context.groupPrev->groupNext == &context);
@@ -433,16 +768,12 @@ void Dispatcher::contextProcedure(void* ucontext) {
           context.groupNext->groupPrev = nullptr;
         } else {
           assert(context.group->lastContext == &context);
-          if (context.group->firstWaiter != nullptr) {
-            if (firstResumingContext != nullptr) {
-              assert(lastResumingContext->next == nullptr);
-              lastResumingContext->next = context.group->firstWaiter;
-            } else {
-              firstResumingContext = context.group->firstWaiter;
-            }
-
-            lastResumingContext = context.group->lastWaiter;
-            context.group->firstWaiter = nullptr;
+          NativeContext* waiter = context.group->firstWaiter;
+          context.group->firstWaiter = nullptr;
+          while (waiter != nullptr) {
+            NativeContext* nextWaiter = waiter->next;
+            pushContext(waiter);
+            waiter = nextWaiter;
           }
         }
       }
@@ -459,4 +790,12 @@ void Dispatcher::contextProcedureStatic(void *context) {
   makingContextData->dispatcher->contextProcedure(makingContextData->ucontext);
 }
 
+void Dispatcher::idleProcedureStatic(void* thread) {
+  ThreadState* threadState = static_cast<ThreadState*>(thread);
+  threadState->dispatcher->runThread(*threadState);
+  // the calling thread never stops: the dispatcher is destroyed from its main context
+  assert(false);
+  std::abort();
+}
+
 }
@@ -4,10 +4,13 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <functional>
+#include <memory>
 #include <queue>
 #include <stack>
+#include <vector>
 
 namespace System {
 
@@ -45,7 +48,12 @@ struct ContextPair {
 
 class Dispatcher {
 public:
+  // Uses the default thread count, which is 1 unless changed with setDefaultThreadCount
   Dispatcher();
+  // Runs contexts on 'threadCount' threads: the calling one and 'threadCount' - 1 started by the dispatcher.
+  // Every thread has its own run queue and idle threads steal contexts from the others, so a context
+  // may be resumed on any thread. The main context is always resumed on the calling thread.
+  explicit Dispatcher(size_t threadCount);
   Dispatcher(const Dispatcher&) = delete;
   ~Dispatcher();
   Dispatcher& operator=(const Dispatcher&) = delete;
@@ -59,6 +67,14 @@ public:
   void remoteSpawn(std::function<void()>&& procedure);
   void yield();
 
+  // Guards contexts, waiters and the epoll when running on several threads, does nothing otherwise.
+  // System primitives hold it while they touch dispatcher state; every method except yield, clear and remoteSpawn expects it to be held.
+  // It is not bound to a thread: a context switch keeps it locked and the resumed context releases it.
+  void lock();
+  void unlock();
+
+  static void setDefaultThreadCount(size_t threadCount);
+
   // system-dependent
   int getEpoll() const;
   NativeContext& getReusableContext();
@@ -77,7 +93,17 @@ public:
 #endif
 
 private:
+  struct ThreadState;
+
   void spawn(std::function<void()>&& procedure);
+  void processEvents();
+  bool hasResumingContexts();
+  NativeContext* takeContext(ThreadState& thread);
+  ThreadState* currentThread() const;
+  void wakeThread(ThreadState& thread);
+  void runThread(ThreadState& thread);
+  void startThreads(size_t threadCount);
+  void stopThreads();
   int epoll;
   alignas(void*) uint8_t mutex[SIZEOF_PTHREAD_MUTEX_T];
   int remoteSpawnEvent;
@@ -93,8 +119,15 @@ private:
   NativeContext* firstReusableContext;
   size_t runningContextCount;
 
+  // multi-threaded mode only, empty when running on the calling thread alone
+  std::vector<std::unique_ptr<ThreadState>> threads;
+  std::atomic<bool> stateLock;
+  size_t idleThreadCount;
+  bool stopping;
+
   void contextProcedure(void* ucontext);
   static void contextProcedureStatic(void* context);
+  static void idleProcedureStatic(void* thread);
 };
 
 }
@@ -4,6 +4,7 @@
 
 #include "Ipv4Resolver.h"
 #include <cassert>
+#include <mutex>
 #include <random>
 #include <stdexcept>
 
@@ -42,8 +43,11 @@ Ipv4Resolver& Ipv4Resolver::operator=(Ipv4Resolver&& other) {
 
 Ipv4Address Ipv4Resolver::resolve(const std::string& host) {
   assert(dispatcher != nullptr);
-  if (dispatcher->interrupted()) {
-    throw InterruptedException();
+  {
+    std::lock_guard<Dispatcher> lock(*dispatcher);
+    if (dispatcher->interrupted()) {
+      throw InterruptedException();
+    }
   }
 
   addrinfo hints = { 0, AF_INET, SOCK_STREAM, IPPROTO_TCP, 0, NULL, NULL, NULL };
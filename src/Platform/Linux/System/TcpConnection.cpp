@@ -4,9 +4,13 @@
 
 #include "TcpConnection.h"
 
+#include <algorithm>
 #include <arpa/inet.h>
 #include <cassert>
+#include <mutex>
 #include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <System/ErrorMessage.h>
@@ -15,6 +19,26 @@
 
 namespace System {
 
+namespace {
+
+const std::size_t MAX_BUFFERS_PER_WRITE = 64;
+
+ssize_t sendBuffers(int connection, const TcpConnection::Buffer* buffers, std::size_t count) {
+  iovec vectors[MAX_BUFFERS_PER_WRITE];
+  count = std::min(count, MAX_BUFFERS_PER_WRITE);
+  for (std::size_t i = 0; i < count; ++i) {
+    vectors[i].iov_base = const_cast<uint8_t*>(buffers[i].data);
+    vectors[i].iov_len = buffers[i].size;
+  }
+
+  msghdr message = msghdr();
+  message.msg_iov = vectors;
+  message.msg_iovlen = count;
+  return ::sendmsg(connection, &message, MSG_NOSIGNAL);
+}
+
+}
+
 TcpConnection::TcpConnection() : dispatcher(nullptr) {
 }
 
@@ -60,6 +84,7 @@ TcpConnection& TcpConnection::operator=(TcpConnection&& other) {
 
 size_t TcpConnection::read(uint8_t* data, size_t size) {
   assert(dispatcher != nullptr);
+  std::lock_guard<Dispatcher> lock(*dispatcher);
   assert(contextPair.readContext == nullptr);
   if (dispatcher->interrupted()) {
     throw InterruptedException();
@@ -148,12 +173,13 @@ size_t TcpConnection::read(uint8_t* data, size_t size) {
 
 std::size_t TcpConnection::write(const uint8_t* data, size_t size) {
   assert(dispatcher != nullptr);
-  assert(contextPair.writeContext == nullptr);
-  if (dispatcher->interrupted()) {
-    throw InterruptedException();
+  {
+    std::lock_guard<Dispatcher> lock(*dispatcher);
+    if (dispatcher->interrupted()) {
+      throw InterruptedException();
+    }
   }
 
-  std::string message;
   if(size == 0) {
     if(shutdown(connection, SHUT_WR) == -1) {
       throw std::runtime_error("TcpConnection::write, shutdown failed, " + lastErrorMessage());
@@ -162,7 +188,21 @@ std::size_t TcpConnection::write(const uint8_t* data, size_t size) {
     return 0;
   }
 
-  ssize_t transferred = ::send(connection, (void *)data, size, MSG_NOSIGNAL);
+  Buffer buffer = { data, size };
+  return writeBuffers(&buffer, 1);
+}
+
+std::size_t TcpConnection::writeBuffers(const Buffer* buffers, std::size_t count) {
+  assert(dispatcher != nullptr);
+  assert(contextPair.writeContext == nullptr);
+  assert(count > 0);
+  std::lock_guard<Dispatcher> lock(*dispatcher);
+  if (dispatcher->interrupted()) {
+    throw InterruptedException();
+  }
+
+  std::string message;
+  ssize_t transferred = sendBuffers(connection, buffers, count);
   if (transferred == -1) {
     if (errno != EAGAIN  && errno != EWOULDBLOCK) {
       message = "send failed, " + lastErrorMessage();
@@ -225,11 +265,10 @@ std::size_t TcpConnection::write(const uint8_t* data, size_t size) {
           throw std::runtime_error("TcpConnection::write, events & (EPOLLERR | EPOLLHUP) != 0");
         }
 
-        ssize_t transferred = ::send(connection, (void *)data, size, 0);
+        ssize_t transferred = sendBuffers(connection, buffers, count);
         if (transferred == -1) {
           message = "send failed, "  + lastErrorMessage();
         } else {
-          assert(transferred <= static_cast<ssize_t>(size));
           return transferred;
         }
       }
@@ -238,7 +277,6 @@ std::size_t TcpConnection::write(const uint8_t* data, size_t size) {
     throw std::runtime_error("TcpConnection::write, " + message);
   }
 
-  assert(transferred <= static_cast<ssize_t>(size));
   return transferred;
 }
 
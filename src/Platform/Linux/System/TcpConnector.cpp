@@ -4,6 +4,7 @@
 
 #include "TcpConnector.h"
 #include <cassert>
+#include <mutex>
 #include <stdexcept>
 
 #include <fcntl.h>
@@ -57,6 +58,7 @@ TcpConnector& TcpConnector::operator=(TcpConnector&& other) {
 
 TcpConnection TcpConnector::connect(const Ipv4Address& address, uint16_t port) {
   assert(dispatcher != nullptr);
+  std::lock_guard<Dispatcher> lock(*dispatcher);
   assert(context == nullptr);
   if (dispatcher->interrupted()) {
     throw InterruptedException();
@@ -4,6 +4,7 @@
 
 #include "TcpListener.h"
 #include <cassert>
+#include <mutex>
 #include <stdexcept>
 
 #include <fcntl.h>
@@ -105,6 +106,7 @@ TcpListener& TcpListener::operator=(TcpListener&& other) {
 
 TcpConnection TcpListener::accept() {
   assert(dispatcher != nullptr);
+  std::lock_guard<Dispatcher> lock(*dispatcher);
   assert(context == nullptr);
   if (dispatcher->interrupted()) {
     throw InterruptedException();
@@ -4,6 +4,7 @@
 
 #include "Timer.h"
 #include <cassert>
+#include <mutex>
 #include <stdexcept>
 
 #include <sys/timerfd.h>
@@ -52,11 +53,13 @@ Timer& Timer::operator=(Timer&& other) {
 void Timer::sleep(std::chrono::nanoseconds duration) {
   assert(dispatcher != nullptr);
   assert(context == nullptr);
+  std::unique_lock<Dispatcher> lock(*dispatcher);
   if (dispatcher->interrupted()) {
     throw InterruptedException();
   }
 
   if(duration.count() == 0 ) {
+    lock.unlock();
     dispatcher->yield();
   } else {
     timer = dispatcher->getTimer();
@@ -54,6 +54,13 @@ public:
   void remoteSpawn(std::function<void()>&& procedure);
   void yield();
 
+  // Contexts always run on the calling thread, so there is no state to guard
+  void lock() {
+  }
+
+  void unlock() {
+  }
+
   int getKqueue() const;
   NativeContext& getReusableContext();
   void pushReusableContext(NativeContext&);
@@ -3,12 +3,14 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "TcpConnection.h"
+#include <algorithm>
 #include <cassert>
 
 #include <netinet/in.h>
 #include <sys/event.h>
 #include <sys/errno.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include "Dispatcher.h"
@@ -18,6 +20,23 @@
 
 namespace System {
 
+namespace {
+
+const size_t MAX_BUFFERS_PER_WRITE = 64;
+
+ssize_t sendBuffers(int connection, const TcpConnection::Buffer* buffers, size_t count) {
+  iovec vectors[MAX_BUFFERS_PER_WRITE];
+  count = std::min(count, MAX_BUFFERS_PER_WRITE);
+  for (size_t i = 0; i < count; ++i) {
+    vectors[i].iov_base = const_cast<uint8_t*>(buffers[i].data);
+    vectors[i].iov_len = buffers[i].size;
+  }
+
+  return ::writev(connection, vectors, static_cast<int>(count));
+}
+
+}
+
 TcpConnection::TcpConnection() : dispatcher(nullptr) {
 }
 
@@ -132,12 +151,10 @@ size_t TcpConnection::read(uint8_t* data, size_t size) {
 
 size_t TcpConnection::write(const uint8_t* data, size_t size) {
   assert(dispatcher != nullptr);
-  assert(writeContext == nullptr);
   if (dispatcher->interrupted()) {
     throw InterruptedException();
   }
 
-  std::string message;
   if (size == 0) {
     if (shutdown(connection, SHUT_WR) == -1) {
       throw std::runtime_error("TcpConnection::write, shutdown failed, " + lastErrorMessage());
@@ -146,7 +163,20 @@ size_t TcpConnection::write(const uint8_t* data, size_t size) {
     return 0;
   }
 
-  ssize_t transferred = ::send(connection, (void *)data, size, 0);
+  Buffer buffer = { data, size };
+  return writeBuffers(&buffer, 1);
+}
+
+size_t TcpConnection::writeBuffers(const Buffer* buffers, size_t count) {
+  assert(dispatcher != nullptr);
+  assert(writeContext == nullptr);
+  assert(count > 0);
+  if (dispatcher->interrupted()) {
+    throw InterruptedException();
+  }
+
+  std::string message;
+  ssize_t transferred = sendBuffers(connection, buffers, count);
   if (transferred == -1) {
     if (errno != EAGAIN  && errno != EWOULDBLOCK) {
       message = "send failed, " + lastErrorMessage();
@@ -188,11 +218,10 @@ size_t TcpConnection::write(const uint8_t* data, size_t size) {
           throw InterruptedException();
         }
 
-        ssize_t transferred = ::send(connection, (void *)data, size, 0);
+        ssize_t transferred = sendBuffers(connection, buffers, count);
         if (transferred == -1) {
           message = "send failed, " + lastErrorMessage();
         } else {
-          assert(transferred <= static_cast<ssize_t>(size));
           return transferred;
         }
       }
@@ -201,7 +230,6 @@ size_t TcpConnection::write(const uint8_t* data, size_t size) {
     throw std::runtime_error("TcpConnection::write, " + message);
   }
 
-  assert(transferred <= static_cast<ssize_t>(size));
   return transferred;
 }
 
@@ -23,6 +23,14 @@ public:
   TcpConnection& operator=(TcpConnection&& other);
   std::size_t read(uint8_t* data, std::size_t size);
   std::size_t write(const uint8_t* data, std::size_t size);
+
+  struct Buffer {
+    const uint8_t* data;
+    std::size_t size;
+  };
+
+  // Writes as much of the buffers as possible in one system call, in order, returns number of bytes written
+  std::size_t writeBuffers(const Buffer* buffers, std::size_t count);
   std::pair<Ipv4Address, uint16_t> getPeerAddressAndPort() const;
 
 private:
@@ -47,6 +47,13 @@ public:
   void remoteSpawn(std::function<void()>&& procedure);
   void yield();
 
+  // Contexts always run on the calling thread, so there is no state to guard
+  void lock() {
+  }
+
+  void unlock() {
+  }
+
   // Platform-specific
   void addTimer(uint64_t time, NativeContext* context);
   void* getCompletionPort() const;
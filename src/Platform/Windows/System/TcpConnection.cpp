@@ -4,6 +4,7 @@
 
 #include "TcpConnection.h"
 #include <cassert>
+#include <vector>
 #ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN
 #endif
@@ -134,7 +135,6 @@ size_t TcpConnection::read(uint8_t* data, size_t size) {
 
 size_t TcpConnection::write(const uint8_t* data, size_t size) {
   assert(dispatcher != nullptr);
-  assert(writeContext == nullptr);
   if (dispatcher->interrupted()) {
     throw InterruptedException();
   }
@@ -147,10 +147,29 @@ size_t TcpConnection::write(const uint8_t* data, size_t size) {
     return 0;
   }
 
-  WSABUF buf{static_cast<ULONG>(size), reinterpret_cast<char*>(const_cast<uint8_t*>(data))};
+  Buffer buffer = { data, size };
+  return writeBuffers(&buffer, 1);
+}
+
+size_t TcpConnection::writeBuffers(const Buffer* buffers, size_t count) {
+  assert(dispatcher != nullptr);
+  assert(writeContext == nullptr);
+  assert(count > 0);
+  if (dispatcher->interrupted()) {
+    throw InterruptedException();
+  }
+
+  std::vector<WSABUF> bufs(count);
+  size_t size = 0;
+  for (size_t i = 0; i < count; ++i) {
+    bufs[i].len = static_cast<ULONG>(buffers[i].size);
+    bufs[i].buf = reinterpret_cast<char*>(const_cast<uint8_t*>(buffers[i].data));
+    size += buffers[i].size;
+  }
+
   TcpConnectionContext context;
   context.hEvent = NULL;
-  if (WSASend(connection, &buf, 1, NULL, 0, &context, NULL) != 0) {
+  if (WSASend(connection, bufs.data(), static_cast<DWORD>(count), NULL, 0, &context, NULL) != 0) {
     int lastError = WSAGetLastError();
     if (lastError != WSA_IO_PENDING) {
       throw std::runtime_error("TcpConnection::write, WSASend failed, " + errorMessage(lastError));
@@ -22,6 +22,14 @@ public:
   TcpConnection& operator=(TcpConnection&& other);
   size_t read(uint8_t* data, size_t size);
   size_t write(const uint8_t* data, size_t size);
+
+  struct Buffer {
+    const uint8_t* data;
+    size_t size;
+  };
+
+  // Writes the buffers in one operation, in order, returns number of bytes written
+  size_t writeBuffers(const Buffer* buffers, size_t count);
   std::pair<Ipv4Address, uint16_t> getPeerAddressAndPort() const;
 
 private:
@@ -267,6 +267,10 @@ struct COMMAND_RPC_GET_INFO {
     uint64_t white_peerlist_size;
     uint64_t grey_peerlist_size;
     uint32_t last_known_block_index;
+    uint64_t block_cache_hits;
+    uint64_t block_cache_misses;
+    double sync_blocks_per_second;
+    double sync_bytes_per_second;
 
     void serialize(ISerializer &s) {
       KV_MEMBER(status)
@@ -280,6 +284,10 @@ struct COMMAND_RPC_GET_INFO {
       KV_MEMBER(white_peerlist_size)
       KV_MEMBER(grey_peerlist_size)
       KV_MEMBER(last_known_block_index)
+      KV_MEMBER(block_cache_hits)
+      KV_MEMBER(block_cache_misses)
+      KV_MEMBER(sync_blocks_per_second)
+      KV_MEMBER(sync_bytes_per_second)
     }
   };
 };
@@ -340,6 +340,8 @@ bool RpcServer::on_get_info(const COMMAND_RPC_GET_INFO::request& req, COMMAND_RP
   res.white_peerlist_size = m_p2p.getPeerlistManager().get_white_peers_count();
   res.grey_peerlist_size = m_p2p.getPeerlistManager().get_gray_peers_count();
   res.last_known_block_index = std::max(static_cast<uint32_t>(1), m_protocolQuery.getObservedHeight()) - 1;
+  m_core.get_block_cache_statistics(res.block_cache_hits, res.block_cache_misses);
+  m_protocolQuery.getSyncSpeed(res.sync_blocks_per_second, res.sync_bytes_per_second);
   res.status = CORE_RPC_STATUS_OK;
   return true;
 }
@@ -391,13 +393,9 @@ bool RpcServer::on_send_raw_tx(const COMMAND_RPC_SEND_RAW_TX::request& req, COMM
     return true;
   }
 
-  tx_verification_context tvc = boost::value_initialized<tx_verification_context>();
-  if (!m_core.handle_incoming_tx(tx_blob, tvc, false))
-  {
-    logger(INFO) << "[on_send_raw_tx]: Failed to process tx";
-    res.status = "Failed";
-    return true;
-  }
+  std::vector<tx_verification_context> tvcs;
+  m_core.handleIncomingTransactions(std::vector<BinaryArray>{ tx_blob }, tvcs, false);
+  const tx_verification_context& tvc = tvcs.front();
 
   if (tvc.m_verification_failed)
   {
@@ -474,27 +472,21 @@ bool RpcServer::f_on_blocks_list_json(const F_COMMAND_RPC_GET_BLOCKS_LIST::reque
   } 
 
   for (uint32_t i = req.height; i >= last_height; i--) {
-    Hash block_hash = m_core.getBlockIdByHeight(static_cast<uint32_t>(i));
-    Block blk;
-    if (!m_core.getBlockByHash(block_hash, blk)) {
+    BlockHeaderInfo header;
+    if (!m_core.getBlockHeaderInfo(i, header)) {
       throw JsonRpc::JsonRpcError{ CORE_RPC_ERROR_CODE_INTERNAL_ERROR,
         "Internal error: can't get block by height. Height = " + std::to_string(i) + '.' };
     }
 
-    size_t tx_cumulative_block_size;
-    m_core.getBlockSize(block_hash, tx_cumulative_block_size);
-    size_t blokBlobSize = getObjectBinarySize(blk);
-    size_t minerTxBlobSize = getObjectBinarySize(blk.baseTransaction);
     difficulty_type blockDiff;
     m_core.getBlockDifficulty(static_cast<uint32_t>(i), blockDiff);
 
     f_block_short_response block_short;
-    block_short.cumul_size = blokBlobSize + tx_cumulative_block_size - minerTxBlobSize;
-    block_short.timestamp = blk.timestamp;
+    block_short.timestamp = header.timestamp;
     block_short.height = i;
-    block_short.hash = Common::podToHex(block_hash);
-    block_short.cumul_size = blokBlobSize + tx_cumulative_block_size - minerTxBlobSize;
-    block_short.tx_count = blk.transactionHashes.size() + 1;
+    block_short.hash = Common::podToHex(header.hash);
+    block_short.cumul_size = header.headerSize + header.blockCumulativeSize;
+    block_short.tx_count = header.transactionCount;
 	block_short.difficulty = blockDiff;
 
     res.blocks.push_back(block_short);
@@ -1,4 +1,4 @@
-// Copyright (c) 2017-2018 The TycheCash developers  ; Originally forked from Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers 
+// Copyright (c) 2017-2018 The TycheCash developers  ; Originally forked from Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
 // Distributed under the MIT/X11 software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -16,6 +16,9 @@ using namespace TycheCash;
 
 namespace {
 
+// nesting of objects which are skipped without being requested
+const size_t MAX_SKIPPED_DEPTH = 100;
+
 template <typename T>
 T readPod(Common::IInputStream& s) {
   T v;
@@ -23,19 +26,21 @@ T readPod(Common::IInputStream& s) {
   return v;
 }
 
-template <typename T, typename JsonT = T>
-JsonValue readPodJson(Common::IInputStream& s) {
-  JsonValue jv;
-  jv = static_cast<JsonT>(readPod<T>(s));
-  return jv;
-}
-
-template <typename T>
-JsonValue readIntegerJson(Common::IInputStream& s) {
-  return readPodJson<T, int64_t>(s);
+// Copies the next 'size' bytes of the stream to 'capture' if it is not null, drops them otherwise
+void readBytes(Common::IInputStream& s, size_t size, std::string* capture) {
+  char buffer[4096];
+  while (size > 0) {
+    size_t chunk = std::min(size, sizeof(buffer));
+    read(s, buffer, chunk);
+    if (capture != nullptr) {
+      capture->append(buffer, chunk);
+    }
+
+    size -= chunk;
+  }
 }
 
-size_t readVarint(Common::IInputStream& s) {
+size_t readVarint(Common::IInputStream& s, std::string* capture = nullptr) {
   uint8_t b = read<uint8_t>(s);
   uint8_t size_mask = b & PORTABLE_RAW_SIZE_MARK_MASK;
   size_t bytesLeft = 0;
@@ -55,139 +60,390 @@ size_t readVarint(Common::IInputStream& s) {
     break;
   }
 
+  if (capture != nullptr) {
+    capture->push_back(static_cast<char>(b));
+  }
+
   size_t value = b;
 
   for (size_t i = 1; i <= bytesLeft; ++i) {
-    size_t n = read<uint8_t>(s);
-    value |= n << (i * 8);
+    uint8_t n = read<uint8_t>(s);
+    if (capture != nullptr) {
+      capture->push_back(static_cast<char>(n));
+    }
+
+    value |= static_cast<size_t>(n) << (i * 8);
   }
 
   value >>= 2;
   return value;
 }
 
-std::string readString(Common::IInputStream& s) {
-  auto size = readVarint(s);
-  std::string str;
-  str.resize(size);
-  if (size) {
-    read(s, &str[0], size);
+size_t readStringSize(Common::IInputStream& s, std::string* capture = nullptr) {
+  size_t size = readVarint(s, capture);
+  if (size > MAX_STRING_LEN_POSSIBLE) {
+    throw std::runtime_error("String is too long");
   }
-  return str;
-}
 
-JsonValue readStringJson(Common::IInputStream& s) {
-  return JsonValue(readString(s));
+  return size;
 }
 
 void readName(Common::IInputStream& s, std::string& name) {
   uint8_t len = readPod<uint8_t>(s);
+  name.resize(len);
   if (len) {
-    name.resize(len);
     read(s, &name[0], len);
   }
 }
 
-JsonValue loadValue(Common::IInputStream& stream, uint8_t type);
-JsonValue loadSection(Common::IInputStream& stream);
-JsonValue loadEntry(Common::IInputStream& stream);
-JsonValue loadArray(Common::IInputStream& stream, uint8_t itemType);
+int64_t readInteger(Common::IInputStream& s, uint8_t type) {
+  switch (type) {
+  case BIN_KV_SERIALIZE_TYPE_INT64:  return readPod<int64_t>(s);
+  case BIN_KV_SERIALIZE_TYPE_INT32:  return readPod<int32_t>(s);
+  case BIN_KV_SERIALIZE_TYPE_INT16:  return readPod<int16_t>(s);
+  case BIN_KV_SERIALIZE_TYPE_INT8:   return readPod<int8_t>(s);
+  case BIN_KV_SERIALIZE_TYPE_UINT64: return static_cast<int64_t>(readPod<uint64_t>(s));
+  case BIN_KV_SERIALIZE_TYPE_UINT32: return readPod<uint32_t>(s);
+  case BIN_KV_SERIALIZE_TYPE_UINT16: return readPod<uint16_t>(s);
+  case BIN_KV_SERIALIZE_TYPE_UINT8:  return readPod<uint8_t>(s);
+  default:
+    throw std::runtime_error("Integer value expected");
+  }
+}
 
+void skipValue(Common::IInputStream& s, uint8_t type, std::string* capture, size_t depth);
 
-JsonValue loadSection(Common::IInputStream& stream) {
-  JsonValue sec(JsonValue::OBJECT);
-  size_t count = readVarint(stream);
-  std::string name;
+void skipSection(Common::IInputStream& s, std::string* capture, size_t depth) {
+  if (depth > MAX_SKIPPED_DEPTH) {
+    throw std::runtime_error("Objects are nested too deep");
+  }
 
+  size_t count = readVarint(s, capture);
   while (count--) {
-    readName(stream, name);
-    sec.insert(name, loadEntry(stream));
+    uint8_t nameLength = readPod<uint8_t>(s);
+    if (capture != nullptr) {
+      capture->push_back(static_cast<char>(nameLength));
+    }
+
+    readBytes(s, nameLength, capture);
+
+    uint8_t type = readPod<uint8_t>(s);
+    if (capture != nullptr) {
+      capture->push_back(static_cast<char>(type));
+    }
+
+    skipValue(s, type, capture, depth);
   }
+}
 
-  return sec;
+void skipArray(Common::IInputStream& s, uint8_t itemType, std::string* capture, size_t depth) {
+  size_t count = readVarint(s, capture);
+  while (count--) {
+    skipValue(s, itemType, capture, depth);
+  }
 }
 
-JsonValue loadValue(Common::IInputStream& stream, uint8_t type) {
+// Reads the value of the given type, copies it to 'capture' if it is not null
+void skipValue(Common::IInputStream& s, uint8_t type, std::string* capture, size_t depth) {
+  if (type & BIN_KV_SERIALIZE_FLAG_ARRAY) {
+    uint8_t itemType = type & ~BIN_KV_SERIALIZE_FLAG_ARRAY;
+    if (itemType == BIN_KV_SERIALIZE_TYPE_ARRAY) {
+      throw std::runtime_error("Nested arrays are not supported");
+    }
+
+    skipArray(s, itemType, capture, depth);
+    return;
+  }
+
   switch (type) {
-  case BIN_KV_SERIALIZE_TYPE_INT64:  return readIntegerJson<int64_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_INT32:  return readIntegerJson<int32_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_INT16:  return readIntegerJson<int16_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_INT8:   return readIntegerJson<int8_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_UINT64: return readIntegerJson<uint64_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_UINT32: return readIntegerJson<uint32_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_UINT16: return readIntegerJson<uint16_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_UINT8:  return readIntegerJson<uint8_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_DOUBLE: return readPodJson<double>(stream);
-  case BIN_KV_SERIALIZE_TYPE_BOOL:   return JsonValue(read<uint8_t>(stream) != 0);
-  case BIN_KV_SERIALIZE_TYPE_STRING: return readStringJson(stream);
-  case BIN_KV_SERIALIZE_TYPE_OBJECT: return loadSection(stream);
-  case BIN_KV_SERIALIZE_TYPE_ARRAY:  return loadArray(stream, type);
+  case BIN_KV_SERIALIZE_TYPE_INT64:
+  case BIN_KV_SERIALIZE_TYPE_UINT64:
+  case BIN_KV_SERIALIZE_TYPE_DOUBLE:
+    readBytes(s, 8, capture);
+    break;
+  case BIN_KV_SERIALIZE_TYPE_INT32:
+  case BIN_KV_SERIALIZE_TYPE_UINT32:
+    readBytes(s, 4, capture);
+    break;
+  case BIN_KV_SERIALIZE_TYPE_INT16:
+  case BIN_KV_SERIALIZE_TYPE_UINT16:
+    readBytes(s, 2, capture);
+    break;
+  case BIN_KV_SERIALIZE_TYPE_INT8:
+  case BIN_KV_SERIALIZE_TYPE_UINT8:
+  case BIN_KV_SERIALIZE_TYPE_BOOL:
+    readBytes(s, 1, capture);
+    break;
+  case BIN_KV_SERIALIZE_TYPE_STRING:
+    readBytes(s, readStringSize(s, capture), capture);
+    break;
+  case BIN_KV_SERIALIZE_TYPE_OBJECT:
+    skipSection(s, capture, depth + 1);
+    break;
   default:
     throw std::runtime_error("Unknown data type");
-    break;
   }
 }
 
-JsonValue loadEntry(Common::IInputStream& stream) {
-  uint8_t type = readPod<uint8_t>(stream);
+}
+
+KVBinaryInputStreamSerializer::KVBinaryInputStreamSerializer(Common::IInputStream& strm) {
+  auto hdr = readPod<KVBinaryStorageBlockHeader>(strm);
 
-  if (type & BIN_KV_SERIALIZE_FLAG_ARRAY) {
-    type &= ~BIN_KV_SERIALIZE_FLAG_ARRAY;
-    return loadArray(stream, type);
+  if (
+    hdr.m_signature_a != PORTABLE_STORAGE_SIGNATUREA ||
+    hdr.m_signature_b != PORTABLE_STORAGE_SIGNATUREB) {
+    throw std::runtime_error("Invalid binary storage signature");
   }
 
-  return loadValue(stream, type);
+  if (hdr.m_ver != PORTABLE_STORAGE_FORMAT_VER) {
+    throw std::runtime_error("Unknown binary storage format version");
+  }
+
+  Level root;
+  root.isArray = false;
+  root.itemType = 0;
+  root.count = readVarint(strm);
+  root.source.stream = &strm;
+  m_levels.push_back(std::move(root));
 }
 
-JsonValue loadArray(Common::IInputStream& stream, uint8_t itemType) {
-  JsonValue arr(JsonValue::ARRAY);
-  size_t count = readVarint(stream);
+KVBinaryInputStreamSerializer::~KVBinaryInputStreamSerializer() {
+}
 
-  while (count--) {
-    arr.pushBack(loadValue(stream, itemType));
+ISerializer::SerializerType KVBinaryInputStreamSerializer::type() const {
+  return ISerializer::INPUT;
+}
+
+bool KVBinaryInputStreamSerializer::beginObject(Common::StringView name) {
+  Level level;
+  uint8_t type;
+  if (!findEntry(name, type, level.source)) {
+    return false;
+  }
+
+  if (type != BIN_KV_SERIALIZE_TYPE_OBJECT) {
+    throw std::runtime_error("Object expected: " + std::string(name.getData(), name.getSize()));
   }
 
-  return arr;
+  level.isArray = false;
+  level.itemType = 0;
+  level.count = readVarint(*level.source.stream);
+  m_levels.push_back(std::move(level));
+  return true;
 }
 
+void KVBinaryInputStreamSerializer::endObject() {
+  assert(m_levels.size() > 1 && !m_levels.back().isArray);
+  skipRest(m_levels.back());
+  m_levels.pop_back();
+}
 
-JsonValue parseBinary(Common::IInputStream& stream) {
-  auto hdr = readPod<KVBinaryStorageBlockHeader>(stream);
+bool KVBinaryInputStreamSerializer::beginArray(size_t& size, Common::StringView name) {
+  Level level;
+  uint8_t type;
+  if (!findEntry(name, type, level.source)) {
+    size = 0;
+    return false;
+  }
 
-  if (
-    hdr.m_signature_a != PORTABLE_STORAGE_SIGNATUREA ||
-    hdr.m_signature_b != PORTABLE_STORAGE_SIGNATUREB) {
-    throw std::runtime_error("Invalid binary storage signature");
+  if ((type & BIN_KV_SERIALIZE_FLAG_ARRAY) == 0) {
+    throw std::runtime_error("Array expected: " + std::string(name.getData(), name.getSize()));
   }
 
-  if (hdr.m_ver != PORTABLE_STORAGE_FORMAT_VER) {
-    throw std::runtime_error("Unknown binary storage format version");
+  level.isArray = true;
+  level.itemType = type & ~BIN_KV_SERIALIZE_FLAG_ARRAY;
+  if (level.itemType == BIN_KV_SERIALIZE_TYPE_ARRAY) {
+    throw std::runtime_error("Nested arrays are not supported");
+  }
+
+  level.count = readVarint(*level.source.stream);
+  size = level.count;
+  m_levels.push_back(std::move(level));
+  return true;
+}
+
+void KVBinaryInputStreamSerializer::endArray() {
+  assert(m_levels.size() > 1 && m_levels.back().isArray);
+  skipRest(m_levels.back());
+  m_levels.pop_back();
+}
+
+bool KVBinaryInputStreamSerializer::operator()(uint8_t& value, Common::StringView name) {
+  return readNumber(value, name);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(int16_t& value, Common::StringView name) {
+  return readNumber(value, name);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(uint16_t& value, Common::StringView name) {
+  return readNumber(value, name);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(int32_t& value, Common::StringView name) {
+  return readNumber(value, name);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(uint32_t& value, Common::StringView name) {
+  return readNumber(value, name);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(int64_t& value, Common::StringView name) {
+  return readNumber(value, name);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(uint64_t& value, Common::StringView name) {
+  return readNumber(value, name);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(double& value, Common::StringView name) {
+  ValueSource source;
+  uint8_t type;
+  if (!findEntry(name, type, source)) {
+    return false;
+  }
+
+  if (type == BIN_KV_SERIALIZE_TYPE_DOUBLE) {
+    value = readPod<double>(*source.stream);
+  } else {
+    value = static_cast<double>(readInteger(*source.stream, type));
   }
 
-  return loadSection(stream);
+  return true;
 }
 
+bool KVBinaryInputStreamSerializer::operator()(bool& value, Common::StringView name) {
+  ValueSource source;
+  uint8_t type;
+  if (!findEntry(name, type, source)) {
+    return false;
+  }
+
+  if (type != BIN_KV_SERIALIZE_TYPE_BOOL) {
+    throw std::runtime_error("Bool value expected");
+  }
+
+  value = read<uint8_t>(*source.stream) != 0;
+  return true;
 }
 
-KVBinaryInputStreamSerializer::KVBinaryInputStreamSerializer(Common::IInputStream& strm) : JsonInputValueSerializer(parseBinary(strm)) {
+bool KVBinaryInputStreamSerializer::operator()(std::string& value, Common::StringView name) {
+  return readString(value, name);
 }
 
 bool KVBinaryInputStreamSerializer::binary(void* value, size_t size, Common::StringView name) {
-  std::string str;
-
-  if (!(*this)(str, name)) {
+  ValueSource source;
+  uint8_t type;
+  if (!findEntry(name, type, source)) {
     return false;
   }
 
-  if (str.size() != size) {
+  if (type != BIN_KV_SERIALIZE_TYPE_STRING) {
+    throw std::runtime_error("String value expected");
+  }
+
+  if (readStringSize(*source.stream) != size) {
     throw std::runtime_error("Binary block size mismatch");
   }
 
-  memcpy(value, str.data(), size);
+  read(*source.stream, value, size);
   return true;
 }
 
 bool KVBinaryInputStreamSerializer::binary(std::string& value, Common::StringView name) {
-  return (*this)(value, name); // load as string
+  return readString(value, name);
+}
+
+bool KVBinaryInputStreamSerializer::findEntry(Common::StringView name, uint8_t& type, ValueSource& source) {
+  Level& level = m_levels.back();
+  if (level.isArray) {
+    // items are read in order, names are ignored
+    if (level.count == 0) {
+      throw std::runtime_error("Array has no more items");
+    }
+
+    --level.count;
+    type = level.itemType;
+    source.stream = level.source.stream;
+    return true;
+  }
+
+  for (auto it = level.skipped.begin(); it != level.skipped.end(); ++it) {
+    if (name == Common::StringView(it->name)) {
+      type = it->type;
+      source.buffer = std::move(it->value);
+      source.bufferStream.reset(new Common::MemoryInputStream(source.buffer->data(), source.buffer->size()));
+      source.stream = source.bufferStream.get();
+      level.skipped.erase(it);
+      return true;
+    }
+  }
+
+  Common::IInputStream& stream = *level.source.stream;
+  while (level.count > 0) {
+    --level.count;
+    readName(stream, m_name);
+    uint8_t entryType = readPod<uint8_t>(stream);
+    if (name == Common::StringView(m_name)) {
+      type = entryType;
+      source.stream = &stream;
+      return true;
+    }
+
+    SkippedEntry entry;
+    entry.name = m_name;
+    entry.type = entryType;
+    entry.value.reset(new std::string());
+    skipValue(stream, entryType, entry.value.get(), m_levels.size());
+    level.skipped.push_back(std::move(entry));
+  }
+
+  return false;
+}
+
+template <typename T>
+bool KVBinaryInputStreamSerializer::readNumber(T& value, Common::StringView name) {
+  ValueSource source;
+  uint8_t type;
+  if (!findEntry(name, type, source)) {
+    return false;
+  }
+
+  value = static_cast<T>(readInteger(*source.stream, type));
+  return true;
 }
 
+bool KVBinaryInputStreamSerializer::readString(std::string& value, Common::StringView name) {
+  ValueSource source;
+  uint8_t type;
+  if (!findEntry(name, type, source)) {
+    return false;
+  }
+
+  if (type != BIN_KV_SERIALIZE_TYPE_STRING) {
+    throw std::runtime_error("String value expected");
+  }
+
+  size_t size = readStringSize(*source.stream);
+  value.resize(size);
+  if (size) {
+    read(*source.stream, &value[0], size);
+  }
+
+  return true;
+}
+
+// Moves the stream past the entries or items of the level which were not requested
+void KVBinaryInputStreamSerializer::skipRest(Level& level) {
+  Common::IInputStream& stream = *level.source.stream;
+  while (level.count > 0) {
+    --level.count;
+    if (level.isArray) {
+      skipValue(stream, level.itemType, nullptr, m_levels.size());
+    } else {
+      readName(stream, m_name);
+      skipValue(stream, readPod<uint8_t>(stream), nullptr, m_levels.size());
+    }
+  }
+}
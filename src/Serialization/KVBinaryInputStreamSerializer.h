@@ -1,21 +1,85 @@
-// Copyright (c) 2017-2018 The TycheCash developers  ; Originally forked from Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers 
+// Copyright (c) 2017-2018 The TycheCash developers  ; Originally forked from Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
 // Distributed under the MIT/X11 software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #pragma once
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include <Common/IInputStream.h>
+#include <Common/MemoryInputStream.h>
 #include "ISerializer.h"
-#include "JsonInputValueSerializer.h"
 
 namespace TycheCash {
 
-class KVBinaryInputStreamSerializer : public JsonInputValueSerializer {
+// Reads values straight from the stream in a single pass, without building an intermediate document.
+// Entries are expected in the order they are requested, as KVBinaryOutputStreamSerializer writes them.
+// Entries skipped while looking for a missing or reordered one are kept aside until requested or their section ends.
+class KVBinaryInputStreamSerializer : public ISerializer {
 public:
   KVBinaryInputStreamSerializer(Common::IInputStream& strm);
+  virtual ~KVBinaryInputStreamSerializer();
+
+  SerializerType type() const override;
+
+  virtual bool beginObject(Common::StringView name) override;
+  virtual void endObject() override;
 
+  virtual bool beginArray(size_t& size, Common::StringView name) override;
+  virtual void endArray() override;
+
+  virtual bool operator()(uint8_t& value, Common::StringView name) override;
+  virtual bool operator()(int16_t& value, Common::StringView name) override;
+  virtual bool operator()(uint16_t& value, Common::StringView name) override;
+  virtual bool operator()(int32_t& value, Common::StringView name) override;
+  virtual bool operator()(uint32_t& value, Common::StringView name) override;
+  virtual bool operator()(int64_t& value, Common::StringView name) override;
+  virtual bool operator()(uint64_t& value, Common::StringView name) override;
+  virtual bool operator()(double& value, Common::StringView name) override;
+  virtual bool operator()(bool& value, Common::StringView name) override;
+  virtual bool operator()(std::string& value, Common::StringView name) override;
   virtual bool binary(void* value, size_t size, Common::StringView name) override;
   virtual bool binary(std::string& value, Common::StringView name) override;
+
+  template<typename T>
+  bool operator()(T& value, Common::StringView name) {
+    return ISerializer::operator()(value, name);
+  }
+
+private:
+  // Entry read ahead of the requested one, its value is kept as raw bytes
+  struct SkippedEntry {
+    std::string name;
+    uint8_t type;
+    std::unique_ptr<std::string> value;
+  };
+
+  // Value of an entry which is being read, either from the input stream or from a skipped entry
+  struct ValueSource {
+    Common::IInputStream* stream;
+    std::unique_ptr<std::string> buffer;
+    std::unique_ptr<Common::MemoryInputStream> bufferStream;
+  };
+
+  struct Level {
+    bool isArray;
+    // type of array items
+    uint8_t itemType;
+    // entries or items left in the stream
+    size_t count;
+    ValueSource source;
+    std::vector<SkippedEntry> skipped;
+  };
+
+  bool findEntry(Common::StringView name, uint8_t& type, ValueSource& source);
+  template <typename T> bool readNumber(T& value, Common::StringView name);
+  bool readString(std::string& value, Common::StringView name);
+  void skipRest(Level& level);
+
+  std::vector<Level> m_levels;
+  std::string m_name;
 };
 
 }
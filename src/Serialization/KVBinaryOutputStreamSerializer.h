@@ -18,6 +18,8 @@ public:
   virtual ~KVBinaryOutputStreamSerializer() {}
 
   void dump(Common::IOutputStream& target);
+  // Number of bytes dump() writes
+  size_t dumpSize();
 
   virtual ISerializer::SerializerType type() const override;
 
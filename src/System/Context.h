@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <mutex>
 #include <System/Dispatcher.h>
 #include <System/Event.h>
 #include <System/InterruptedException.h>
@@ -14,7 +15,8 @@ template<typename ResultType = void>
 class Context {
 public:
   Context(Dispatcher& dispatcher, std::function<ResultType()>&& target) : 
-    dispatcher(dispatcher), target(std::move(target)), ready(dispatcher), bindingContext(dispatcher.getReusableContext()) {
+    dispatcher(dispatcher), target(std::move(target)), ready(dispatcher), bindingContext(takeReusableContext(dispatcher)) {
+    std::lock_guard<Dispatcher> lock(dispatcher);
     bindingContext.interrupted = false;
     bindingContext.groupNext = nullptr;
     bindingContext.groupPrev = nullptr;
@@ -38,6 +40,7 @@ public:
   ~Context() {
     interrupt();
     wait();
+    std::lock_guard<Dispatcher> lock(dispatcher);
     dispatcher.pushReusableContext(bindingContext);
   }
 
@@ -51,6 +54,7 @@ public:
   }
 
   void interrupt() {
+    std::lock_guard<Dispatcher> lock(dispatcher);
     dispatcher.interrupt(&bindingContext);
   }
 
@@ -66,6 +70,11 @@ public:
   }
 
 private:
+  static NativeContext& takeReusableContext(Dispatcher& dispatcher) {
+    std::lock_guard<Dispatcher> lock(dispatcher);
+    return dispatcher.getReusableContext();
+  }
+
   uint8_t resultStorage[sizeof(ResultType)];
   Dispatcher& dispatcher;
   std::function<ResultType()> target;
@@ -78,7 +87,8 @@ template<>
 class Context<void> {
 public:
   Context(Dispatcher& dispatcher, std::function<void()>&& target) :
-    dispatcher(dispatcher), target(std::move(target)), ready(dispatcher), bindingContext(dispatcher.getReusableContext()) {
+    dispatcher(dispatcher), target(std::move(target)), ready(dispatcher), bindingContext(takeReusableContext(dispatcher)) {
+    std::lock_guard<Dispatcher> lock(dispatcher);
     bindingContext.interrupted = false;
     bindingContext.groupNext = nullptr;
     bindingContext.groupPrev = nullptr;
@@ -102,6 +112,7 @@ public:
   ~Context() {
     interrupt();
     wait();
+    std::lock_guard<Dispatcher> lock(dispatcher);
     dispatcher.pushReusableContext(bindingContext);
   }
 
@@ -113,6 +124,7 @@ public:
   }
 
   void interrupt() {
+    std::lock_guard<Dispatcher> lock(dispatcher);
     dispatcher.interrupt(&bindingContext);
   }
 
@@ -128,6 +140,11 @@ public:
   }
 
 private:
+  static NativeContext& takeReusableContext(Dispatcher& dispatcher) {
+    std::lock_guard<Dispatcher> lock(dispatcher);
+    return dispatcher.getReusableContext();
+  }
+
   Dispatcher& dispatcher;
   std::function<void()> target;
   Event ready;
@@ -4,6 +4,7 @@
 
 #include "ContextGroup.h"
 #include <cassert>
+#include <mutex>
 
 namespace System {
 
@@ -40,6 +41,7 @@ ContextGroup& ContextGroup::operator=(ContextGroup&& other) {
 
 void ContextGroup::interrupt() {
   assert(dispatcher != nullptr);
+  std::lock_guard<Dispatcher> lock(*dispatcher);
   for (NativeContext* context = contextGroup.firstContext; context != nullptr; context = context->groupNext) {
     dispatcher->interrupt(context);
   }
@@ -47,6 +49,7 @@ void ContextGroup::interrupt() {
 
 void ContextGroup::spawn(std::function<void()>&& procedure) {
   assert(dispatcher != nullptr);
+  std::lock_guard<Dispatcher> lock(*dispatcher);
   NativeContext& context = dispatcher->getReusableContext();
   if (contextGroup.firstContext != nullptr) {
     context.groupPrev = contextGroup.lastContext;
@@ -67,6 +70,7 @@ void ContextGroup::spawn(std::function<void()>&& procedure) {
 }
 
 void ContextGroup::wait() {
+  std::lock_guard<Dispatcher> lock(*dispatcher);
   if (contextGroup.firstContext != nullptr) {
     NativeContext* context = dispatcher->getCurrentContext();
     context->next = nullptr;
@@ -4,6 +4,7 @@
 
 #include "Event.h"
 #include <cassert>
+#include <mutex>
 #include <System/Dispatcher.h>
 #include <System/InterruptedException.h>
 
@@ -60,11 +61,13 @@ Event& Event::operator=(Event&& other) {
 
 bool Event::get() const {
   assert(dispatcher != nullptr);
+  std::lock_guard<Dispatcher> lock(*dispatcher);
   return state;
 }
 
 void Event::clear() {
   assert(dispatcher != nullptr);
+  std::lock_guard<Dispatcher> lock(*dispatcher);
   if (state) {
     state = false;
     first = nullptr;
@@ -73,6 +76,7 @@ void Event::clear() {
 
 void Event::set() {
   assert(dispatcher != nullptr);
+  std::lock_guard<Dispatcher> lock(*dispatcher);
   if (!state) {
     state = true;
     for (EventWaiter* waiter = static_cast<EventWaiter*>(first); waiter != nullptr; waiter = waiter->next) {
@@ -84,6 +88,7 @@ void Event::set() {
 
 void Event::wait() {
   assert(dispatcher != nullptr);
+  std::lock_guard<Dispatcher> lock(*dispatcher);
   if (dispatcher->interrupted()) {
     throw InterruptedException();
   }
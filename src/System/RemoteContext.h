@@ -5,6 +5,7 @@
 #pragma once
 
 #include <cassert>
+#include <mutex>
 #include <System/Dispatcher.h>
 #include <System/Event.h>
 #include <System/Future.h>
@@ -36,6 +37,7 @@ public:
     }
 
     if (interrupted) {
+      std::lock_guard<Dispatcher> lock(dispatcher);
       dispatcher.interrupt();
     }
   }
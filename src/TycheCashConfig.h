@@ -77,6 +77,7 @@ const char     TycheCash_BLOCKSCACHE_FILENAME[]             = "blockscache.dat";
 const char     TycheCash_POOLDATA_FILENAME[]                = "poolstate.bin";
 const char     P2P_NET_DATA_FILENAME[]                      = "p2pstate.bin";
 const char     TycheCash_BLOCKCHAIN_INDICES_FILENAME[]      = "blockchainindices.dat";
+const char     TycheCash_BLOCKHEADERS_FILENAME[]            = "blockheaders.dat";
 const char     MINER_CONFIG_FILE_NAME[]                     = "miner_conf.json";
 } // parameters
 
@@ -95,6 +96,7 @@ const uint8_t  BLOCK_MINOR_VERSION_1						= 1;
 
 const size_t   BLOCKS_IDS_SYNCHRONIZING_DEFAULT_COUNT       = 10000; // by default, blocks ids count in synchronizing
 const size_t   BLOCKS_SYNCHRONIZING_DEFAULT_COUNT           = 128; // by default, blocks count in blocks downloading
+const size_t   BLOCKS_SYNCHRONIZING_MAX_PARKED_COUNT        = 8 * BLOCKS_SYNCHRONIZING_DEFAULT_COUNT; // blocks received out of order and waiting to be applied
 const size_t   COMMAND_RPC_GET_BLOCKS_FAST_MAX_COUNT        = 1000;
 
 const int      P2P_DEFAULT_PORT                             = 17017;
@@ -113,6 +115,9 @@ const uint32_t P2P_DEFAULT_CONNECTION_TIMEOUT               = 5000; // 5 seconds
 const uint32_t P2P_DEFAULT_PING_CONNECTION_TIMEOUT          = 2000; // 2 seconds
 const uint64_t P2P_DEFAULT_INVOKE_TIMEOUT                   = 60 * 2 * 1000; // 2 minutes
 const size_t   P2P_DEFAULT_HANDSHAKE_INVOKE_TIMEOUT         = 5000; // 5 seconds
+const size_t   P2P_KNOWN_TRANSACTIONS_MAX_COUNT             = 50000; // transaction hashes remembered for every connection
+const size_t   P2P_TX_INVENTORY_MAX_COUNT                   = 5000; // transaction hashes in a single announce or request
+const uint32_t P2P_TX_REQUEST_TIMEOUT                       = 30; // seconds to wait for a requested transaction before asking another peer
 const char     P2P_STAT_TRUSTED_PUB_KEY[]                   = "8f80f9a5a434a9f1510d13336228debfee9c918ce505efe225d8c94d045fa115";
 
 const std::initializer_list<const char*> SEED_NODES = {
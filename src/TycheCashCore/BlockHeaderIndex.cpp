@@ -0,0 +1,105 @@
+// Copyright (c) 2017-2018 The TycheCash developers  ; Originally forked from Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "BlockHeaderIndex.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Serialization/ISerializer.h"
+
+namespace TycheCash {
+
+  namespace {
+
+  const uint8_t CURRENT_BLOCK_HEADER_INDEX_VERSION = 1;
+
+  // columns are stored as raw arrays to make loading fast
+  template<typename T>
+  void serializeColumn(std::vector<T>& column, size_t count, Common::StringView name, ISerializer& s) {
+    size_t size = count * sizeof(T);
+    if (!s.beginArray(size, name)) {
+      throw std::runtime_error("Failed to serialize header index column");
+    }
+
+    if (size != count * sizeof(T)) {
+      throw std::runtime_error("Invalid header index column size");
+    }
+
+    if (s.type() == ISerializer::INPUT) {
+      column.resize(count);
+    }
+
+    if (size) {
+      s.binary(column.data(), size, "");
+    }
+
+    s.endArray();
+  }
+
+  }
+
+  void BlockHeaderIndex::resize(uint32_t newSize) {
+    assert(newSize <= size());
+    m_hashes.resize(newSize);
+    m_timestamps.resize(newSize);
+    m_cumulativeDifficulties.resize(newSize);
+    m_blockCumulativeSizes.resize(newSize);
+    m_alreadyGeneratedCoins.resize(newSize);
+    m_headerSizes.resize(newSize);
+    m_transactionCounts.resize(newSize);
+  }
+
+  void BlockHeaderIndex::clear() {
+    resize(0);
+  }
+
+  void BlockHeaderIndex::reserve(uint32_t capacity) {
+    m_hashes.reserve(capacity);
+    m_timestamps.reserve(capacity);
+    m_cumulativeDifficulties.reserve(capacity);
+    m_blockCumulativeSizes.reserve(capacity);
+    m_alreadyGeneratedCoins.reserve(capacity);
+    m_headerSizes.reserve(capacity);
+    m_transactionCounts.reserve(capacity);
+  }
+
+  BlockHeaderInfo BlockHeaderIndex::get(uint32_t height) const {
+    assert(height < size());
+    BlockHeaderInfo header;
+    header.hash = m_hashes[height];
+    header.timestamp = m_timestamps[height];
+    header.cumulativeDifficulty = m_cumulativeDifficulties[height];
+    header.blockCumulativeSize = m_blockCumulativeSizes[height];
+    header.alreadyGeneratedCoins = m_alreadyGeneratedCoins[height];
+    header.headerSize = m_headerSizes[height];
+    header.transactionCount = m_transactionCounts[height];
+    return header;
+  }
+
+  uint32_t BlockHeaderIndex::lowerBound(uint64_t timestamp, uint32_t startHeight) const {
+    assert(startHeight <= size());
+    auto it = std::lower_bound(m_timestamps.begin() + startHeight, m_timestamps.end(), timestamp);
+    return static_cast<uint32_t>(std::distance(m_timestamps.begin(), it));
+  }
+
+  void BlockHeaderIndex::serialize(ISerializer& s) {
+    uint8_t version = CURRENT_BLOCK_HEADER_INDEX_VERSION;
+    s(version, "version");
+    if (version != CURRENT_BLOCK_HEADER_INDEX_VERSION) {
+      throw std::runtime_error("Unsupported block header index version");
+    }
+
+    uint32_t count = size();
+    s(count, "count");
+
+    serializeColumn(m_hashes, count, "hashes", s);
+    serializeColumn(m_timestamps, count, "timestamps", s);
+    serializeColumn(m_cumulativeDifficulties, count, "cumulative_difficulties", s);
+    serializeColumn(m_blockCumulativeSizes, count, "block_cumulative_sizes", s);
+    serializeColumn(m_alreadyGeneratedCoins, count, "already_generated_coins", s);
+    serializeColumn(m_headerSizes, count, "header_sizes", s);
+    serializeColumn(m_transactionCounts, count, "transaction_counts", s);
+  }
+}
@@ -0,0 +1,122 @@
+// Copyright (c) 2017-2018 The TycheCash developers  ; Originally forked from Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "crypto/hash.h"
+#include "TycheCashCore/Difficulty.h"
+
+namespace TycheCash
+{
+  class ISerializer;
+
+  struct BlockHeaderInfo {
+    Crypto::Hash hash;
+    uint64_t timestamp;
+    difficulty_type cumulativeDifficulty;
+    uint64_t blockCumulativeSize;
+    uint64_t alreadyGeneratedCoins;
+    // size of the block blob without its base transaction
+    uint32_t headerSize;
+    // including base transaction
+    uint32_t transactionCount;
+  };
+
+  // Scalar header fields of every main chain block, stored column by column and addressed by block height.
+  // Lets queries and consensus checks read them without loading block entries from the block storage.
+  class BlockHeaderIndex {
+
+  public:
+
+    uint32_t size() const {
+      return static_cast<uint32_t>(m_hashes.size());
+    }
+
+    bool empty() const {
+      return m_hashes.empty();
+    }
+
+    void push(const BlockHeaderInfo& header) {
+      m_hashes.push_back(header.hash);
+      m_timestamps.push_back(header.timestamp);
+      m_cumulativeDifficulties.push_back(header.cumulativeDifficulty);
+      m_blockCumulativeSizes.push_back(header.blockCumulativeSize);
+      m_alreadyGeneratedCoins.push_back(header.alreadyGeneratedCoins);
+      m_headerSizes.push_back(header.headerSize);
+      m_transactionCounts.push_back(header.transactionCount);
+    }
+
+    void pop() {
+      assert(!empty());
+      resize(size() - 1);
+    }
+
+    // Keeps headers of blocks below the given height only
+    void resize(uint32_t newSize);
+    void clear();
+    void reserve(uint32_t capacity);
+
+    BlockHeaderInfo get(uint32_t height) const;
+
+    const Crypto::Hash& hash(uint32_t height) const {
+      assert(height < size());
+      return m_hashes[height];
+    }
+
+    uint64_t timestamp(uint32_t height) const {
+      assert(height < size());
+      return m_timestamps[height];
+    }
+
+    difficulty_type cumulativeDifficulty(uint32_t height) const {
+      assert(height < size());
+      return m_cumulativeDifficulties[height];
+    }
+
+    difficulty_type difficulty(uint32_t height) const {
+      return height == 0 ? cumulativeDifficulty(0) : cumulativeDifficulty(height) - cumulativeDifficulty(height - 1);
+    }
+
+    uint64_t blockCumulativeSize(uint32_t height) const {
+      assert(height < size());
+      return m_blockCumulativeSizes[height];
+    }
+
+    uint64_t alreadyGeneratedCoins(uint32_t height) const {
+      assert(height < size());
+      return m_alreadyGeneratedCoins[height];
+    }
+
+    uint32_t headerSize(uint32_t height) const {
+      assert(height < size());
+      return m_headerSizes[height];
+    }
+
+    uint32_t transactionCount(uint32_t height) const {
+      assert(height < size());
+      return m_transactionCounts[height];
+    }
+
+    // Returns the lowest height in [startHeight, size()) with timestamp not less than the given one, or size().
+    // Timestamps of the main chain are not monotonic, so the result is only as good as for the sorted sequence.
+    uint32_t lowerBound(uint64_t timestamp, uint32_t startHeight) const;
+
+    void serialize(ISerializer& s);
+
+  private:
+
+    std::vector<Crypto::Hash> m_hashes;
+    std::vector<uint64_t> m_timestamps;
+    std::vector<difficulty_type> m_cumulativeDifficulties;
+    std::vector<uint64_t> m_blockCumulativeSizes;
+    std::vector<uint64_t> m_alreadyGeneratedCoins;
+    std::vector<uint32_t> m_headerSizes;
+    std::vector<uint32_t> m_transactionCounts;
+
+  };
+}
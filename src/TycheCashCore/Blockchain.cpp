@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <exception>
 #include <boost/foreach.hpp>
 #include "Common/Math.h"
 #include "Common/ShuffleGenerator.h"
@@ -20,6 +21,9 @@ using namespace Common;
 
 namespace {
 
+// Precomputed proofs of work of blocks which don't get pushed are dropped when there are more than this
+const size_t MAX_PRECOMPUTED_PROOFS_OF_WORK = 10000;
+
 std::string appendPath(const std::string& path, const std::string& fileName) {
   std::string result = path;
   if (!result.empty()) {
@@ -42,8 +46,8 @@ bool operator<(const Crypto::KeyImage& keyImage1, const Crypto::KeyImage& keyIma
 }
 }
 
-#define CURRENT_BLOCKCACHE_STORAGE_ARCHIVE_VER 1
-#define CURRENT_BLOCKCHAININDICES_STORAGE_ARCHIVE_VER 1
+#define CURRENT_BLOCKCACHE_STORAGE_ARCHIVE_VER 3
+#define CURRENT_BLOCKCHAININDICES_STORAGE_ARCHIVE_VER 2
 
 namespace TycheCash {
 class BlockCacheSerializer;
@@ -82,8 +86,9 @@ bool serialize(google::sparse_hash_set<K, Hash>& value, Common::StringView name,
 }
 
 // custom serialization to speedup cache loading
-bool serialize(std::vector<std::pair<Blockchain::TransactionIndex, uint16_t>>& value, Common::StringView name, TycheCash::ISerializer& s) {
-  const size_t elementSize = sizeof(std::pair<Blockchain::TransactionIndex, uint16_t>);
+template<typename T>
+bool serializeColumn(std::vector<T>& value, Common::StringView name, TycheCash::ISerializer& s) {
+  const size_t elementSize = sizeof(T);
   size_t size = value.size() * elementSize;
 
   if (!s.beginArray(size, name)) {
@@ -105,6 +110,16 @@ bool serialize(std::vector<std::pair<Blockchain::TransactionIndex, uint16_t>>& v
   return true;
 }
 
+void Blockchain::KeyOutputs::serialize(ISerializer& s) {
+  serializeColumn(locations, "locations", s);
+  serializeColumn(keys, "keys", s);
+  serializeColumn(unlockTimes, "unlock_times", s);
+
+  if (keys.size() != locations.size() || unlockTimes.size() != locations.size()) {
+    throw std::runtime_error("Output columns size mismatch");
+  }
+}
+
 void serialize(Blockchain::TransactionIndex& value, ISerializer& s) {
   s(value.block, "block");
   s(value.transaction, "tx");
@@ -113,8 +128,8 @@ void serialize(Blockchain::TransactionIndex& value, ISerializer& s) {
 class BlockCacheSerializer {
 
 public:
-  BlockCacheSerializer(Blockchain& bs, const Crypto::Hash lastBlockHash, ILogger& logger) :
-    m_bs(bs), m_lastBlockHash(lastBlockHash), m_loaded(false), logger(logger, "BlockCacheSerializer") {
+  BlockCacheSerializer(Blockchain& bs, ILogger& logger) :
+    m_bs(bs), m_height(0), m_loaded(false), logger(logger, "BlockCacheSerializer") {
   }
 
   void load(const std::string& filename) {
@@ -133,8 +148,10 @@ public:
   }
 
   bool save(const std::string& filename) {
+    // write to a temporary file first, so that interrupted saving doesn't destroy the previous cache
+    const std::string tempFilename = filename + ".tmp";
     try {
-      std::ofstream file(filename, std::ios::binary);
+      std::ofstream file(tempFilename, std::ios::binary);
       if (!file) {
         return false;
       }
@@ -142,11 +159,16 @@ public:
       StdOutputStream stream(file);
       BinaryOutputStreamSerializer s(stream);
       TycheCash::serialize(*this, s);
+
+      file.flush();
+      if (!file) {
+        return false;
+      }
     } catch (std::exception&) {
       return false;
     }
 
-    return true;
+    return !Tools::replace_file(tempFilename, filename);
   }
 
   void serialize(ISerializer& s) {
@@ -163,15 +185,20 @@ public:
     if (s.type() == ISerializer::INPUT) {
       operation = "- loading ";
       Crypto::Hash blockHash;
+      s(m_height, "height");
       s(blockHash, "last_block");
 
-      if (blockHash != m_lastBlockHash) {
+      // cache stored below the top of the blockchain is still usable, blocks above it are replayed
+      if (m_height >= m_bs.m_blocks.size() || blockHash != get_block_hash(m_bs.m_blocks.get(m_height)->bl)) {
         return;
       }
 
     } else {
       operation = "- saving ";
-      s(m_lastBlockHash, "last_block");
+      m_height = static_cast<uint32_t>(m_bs.m_blocks.size() - 1);
+      Crypto::Hash blockHash = m_bs.getTailId();
+      s(m_height, "height");
+      s(blockHash, "last_block");
     }
 
     logger(INFO) << operation << "block index...";
@@ -200,19 +227,24 @@ public:
     return m_loaded;
   }
 
+  // Height of the last block included in the cache
+  uint32_t height() const {
+    return m_height;
+  }
+
 private:
 
   LoggerRef logger;
   bool m_loaded;
   Blockchain& m_bs;
-  Crypto::Hash m_lastBlockHash;
+  uint32_t m_height;
 };
 
 class BlockchainIndicesSerializer {
 
 public:
-  BlockchainIndicesSerializer(Blockchain& bs, const Crypto::Hash lastBlockHash, ILogger& logger) :
-    m_bs(bs), m_lastBlockHash(lastBlockHash), m_loaded(false), logger(logger, "BlockchainIndicesSerializer") {
+  BlockchainIndicesSerializer(Blockchain& bs, ILogger& logger) :
+    m_bs(bs), m_height(0), m_loaded(false), logger(logger, "BlockchainIndicesSerializer") {
   }
 
   void serialize(ISerializer& s) {
@@ -231,15 +263,19 @@ public:
       operation = "- loading ";
 
       Crypto::Hash blockHash;
+      s(m_height, "height");
       s(blockHash, "blockHash");
 
-      if (blockHash != m_lastBlockHash) {
+      if (m_height >= m_bs.m_blocks.size() || blockHash != get_block_hash(m_bs.m_blocks.get(m_height)->bl)) {
         return;
       }
 
     } else {
       operation = "- saving ";
-      s(m_lastBlockHash, "blockHash");
+      m_height = static_cast<uint32_t>(m_bs.m_blocks.size() - 1);
+      Crypto::Hash blockHash = m_bs.getTailId();
+      s(m_height, "height");
+      s(blockHash, "blockHash");
     }
 
     logger(INFO) << operation << "paymentID index...";
@@ -264,15 +300,19 @@ public:
     if (Archive::is_loading::value) {
       operation = "- loading ";
       Crypto::Hash blockHash;
+      ar & m_height;
       ar & blockHash;
 
-      if (blockHash != m_lastBlockHash) {
+      if (m_height >= m_bs.m_blocks.size() || blockHash != get_block_hash(m_bs.m_blocks.get(m_height)->bl)) {
         return;
       }
 
     } else {
       operation = "- saving ";
-      ar & m_lastBlockHash;
+      m_height = static_cast<uint32_t>(m_bs.m_blocks.size() - 1);
+      Crypto::Hash blockHash = m_bs.getTailId();
+      ar & m_height;
+      ar & blockHash;
     }
 
     logger(INFO) << operation << "paymentID index...";
@@ -291,12 +331,17 @@ public:
     return m_loaded;
   }
 
+  // Height of the last block included in the indices
+  uint32_t height() const {
+    return m_height;
+  }
+
 private:
 
   LoggerRef logger;
   bool m_loaded;
   Blockchain& m_bs;
-  Crypto::Hash m_lastBlockHash;
+  uint32_t m_height;
 };
 
 
@@ -306,7 +351,10 @@ m_currency(currency),
 m_tx_pool(tx_pool),
 m_current_block_cumul_sz_limit(0),
 m_is_in_checkpoint_zone(false),
-m_checkpoints(logger) {
+m_checkpoints(logger),
+m_verificationPool(new Tools::ThreadPool(0)),
+m_proofOfWorkPool(new Tools::ThreadPool(0)),
+m_cacheCheckpointInterval(0) {
 
   m_outputs.set_deleted_key(0);
   Crypto::KeyImage nullImage = boost::value_initialized<decltype(nullImage)>();
@@ -381,17 +429,17 @@ bool Blockchain::checkTransactionSize(size_t blobSize) {
 }
 
 bool Blockchain::haveTransaction(const Crypto::Hash &id) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   return m_transactionMap.find(id) != m_transactionMap.end();
 }
 
 bool Blockchain::have_tx_keyimg_as_spent(const Crypto::KeyImage &key_im) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   return  m_spent_keys.find(key_im) != m_spent_keys.end();
 }
 
 uint32_t Blockchain::getCurrentBlockchainHeight() {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   return static_cast<uint32_t>(m_blocks.size());
 }
 
@@ -410,17 +458,23 @@ bool Blockchain::init(const std::string& config_folder, bool load_existing) {
 
   if (load_existing && !m_blocks.empty()) {
     logger(INFO, BRIGHT_WHITE) << "Loading blockchain...";
-    BlockCacheSerializer loader(*this, get_block_hash(m_blocks.back().bl), logger.getLogger());
+    BlockCacheSerializer loader(*this, logger.getLogger());
     loader.load(appendPath(config_folder, m_currency.blocksCacheFileName()));
 
     if (!loader.loaded()) {
       logger(WARNING, BRIGHT_YELLOW) << "No actual blockchain cache found, rebuilding internal structures...";
       rebuildCache();
+    } else if (loader.height() + 1 < m_blocks.size()) {
+      logger(INFO, BRIGHT_WHITE) << "Blockchain cache is stored at height " << loader.height() << ", replaying " <<
+        m_blocks.size() - loader.height() - 1 << " blocks above it...";
+      rebuildCache(loader.height() + 1);
     }
 
     loadBlockchainIndices();
+    loadHeaderIndex();
   } else {
     m_blocks.clear();
+    m_headerIndex.clear();
   }
 
   if (m_blocks.empty()) {
@@ -457,44 +511,75 @@ bool Blockchain::init(const std::string& config_folder, bool load_existing) {
   return true;
 }
 
-void Blockchain::rebuildCache() {
+void Blockchain::rebuildCache(uint32_t startHeight) {
   std::chrono::steady_clock::time_point timePoint = std::chrono::steady_clock::now();
-  m_blockIndex.clear();
-  m_transactionMap.clear();
-  m_spent_keys.clear();
-  m_outputs.clear();
-  m_multisignatureOutputs.clear();
-  for (uint32_t b = 0; b < m_blocks.size(); ++b) {
-    if (b % 1000 == 0) {
-      logger(INFO, BRIGHT_WHITE) << "Height " << b << " of " << m_blocks.size();
-    }
-    const BlockEntry& block = m_blocks[b];
-    Crypto::Hash blockHash = get_block_hash(block.bl);
-    m_blockIndex.push(blockHash);
-    for (uint16_t t = 0; t < block.transactions.size(); ++t) {
-      const TransactionEntry& transaction = block.transactions[t];
-      Crypto::Hash transactionHash = getObjectHash(transaction.tx);
-      TransactionIndex transactionIndex = { b, t };
-      m_transactionMap.insert(std::make_pair(transactionHash, transactionIndex));
-
-      // process inputs
-      for (auto& i : transaction.tx.inputs) {
-        if (i.type() == typeid(KeyInput)) {
-          m_spent_keys.insert(::boost::get<KeyInput>(i).keyImage);
-        } else if (i.type() == typeid(MultisignatureInput)) {
-          auto out = ::boost::get<MultisignatureInput>(i);
-          m_multisignatureOutputs[out.amount][out.outputIndex].isUsed = true;
+  if (startHeight == 0) {
+    m_blockIndex.clear();
+    m_transactionMap.clear();
+    m_spent_keys.clear();
+    m_outputs.clear();
+    m_multisignatureOutputs.clear();
+  }
+
+  // Blocks are loaded and hashed in parallel, chunk by chunk, while indices are updated in blockchain order,
+  // as global output indexes depend on it
+  const uint32_t chunkSize = 1000;
+  std::vector<std::shared_ptr<const BlockEntry>> blocks;
+  std::vector<std::vector<Crypto::Hash>> hashes;
+  std::vector<std::exception_ptr> errors;
+  for (uint32_t chunkStart = startHeight; chunkStart < m_blocks.size(); chunkStart += chunkSize) {
+    logger(INFO, BRIGHT_WHITE) << "Height " << chunkStart << " of " << m_blocks.size();
+    const uint32_t chunkEnd = static_cast<uint32_t>(std::min<uint64_t>(chunkStart + chunkSize, m_blocks.size()));
+
+    blocks.assign(chunkEnd - chunkStart, nullptr);
+    hashes.assign(chunkEnd - chunkStart, std::vector<Crypto::Hash>());
+    errors.assign(chunkEnd - chunkStart, nullptr);
+    m_verificationPool->parallelFor(chunkEnd - chunkStart, [&](size_t i) {
+      try {
+        blocks[i] = m_blocks.get(chunkStart + i);
+        // block hash goes first, then hashes of its transactions
+        hashes[i].reserve(1 + blocks[i]->transactions.size());
+        hashes[i].push_back(get_block_hash(blocks[i]->bl));
+        for (const TransactionEntry& transaction : blocks[i]->transactions) {
+          hashes[i].push_back(getObjectHash(transaction.tx));
         }
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    });
+
+    for (uint32_t b = chunkStart; b < chunkEnd; ++b) {
+      if (errors[b - chunkStart]) {
+        std::rethrow_exception(errors[b - chunkStart]);
       }
 
-      // process outputs
-      for (uint16_t o = 0; o < transaction.tx.outputs.size(); ++o) {
-        const auto& out = transaction.tx.outputs[o];
-        if (out.target.type() == typeid(KeyOutput)) {
-          m_outputs[out.amount].push_back(std::make_pair<>(transactionIndex, o));
-        } else if (out.target.type() == typeid(MultisignatureOutput)) {
-          MultisignatureOutputUsage usage = { transactionIndex, o, false };
-          m_multisignatureOutputs[out.amount].push_back(usage);
+      const BlockEntry& block = *blocks[b - chunkStart];
+      const std::vector<Crypto::Hash>& blockHashes = hashes[b - chunkStart];
+      m_blockIndex.push(blockHashes[0]);
+      for (uint16_t t = 0; t < block.transactions.size(); ++t) {
+        const TransactionEntry& transaction = block.transactions[t];
+        TransactionIndex transactionIndex = { b, t };
+        m_transactionMap.insert(std::make_pair(blockHashes[1 + t], transactionIndex));
+
+        // process inputs
+        for (auto& i : transaction.tx.inputs) {
+          if (i.type() == typeid(KeyInput)) {
+            m_spent_keys.insert(::boost::get<KeyInput>(i).keyImage);
+          } else if (i.type() == typeid(MultisignatureInput)) {
+            auto out = ::boost::get<MultisignatureInput>(i);
+            m_multisignatureOutputs[out.amount][out.outputIndex].isUsed = true;
+          }
+        }
+
+        // process outputs
+        for (uint16_t o = 0; o < transaction.tx.outputs.size(); ++o) {
+          const auto& out = transaction.tx.outputs[o];
+          if (out.target.type() == typeid(KeyOutput)) {
+            m_outputs[out.amount].push(transactionIndex, o, boost::get<KeyOutput>(out.target).key, transaction.tx.unlockTime);
+          } else if (out.target.type() == typeid(MultisignatureOutput)) {
+            MultisignatureOutputUsage usage = { transactionIndex, o, false };
+            m_multisignatureOutputs[out.amount].push_back(usage);
+          }
         }
       }
     }
@@ -508,7 +593,7 @@ bool Blockchain::storeCache() {
   std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
 
   logger(INFO, BRIGHT_WHITE) << "Saving blockchain...";
-  BlockCacheSerializer ser(*this, getTailId(), logger.getLogger());
+  BlockCacheSerializer ser(*this, logger.getLogger());
   if (!ser.save(appendPath(m_config_folder, m_currency.blocksCacheFileName()))) {
     logger(ERROR, BRIGHT_RED) << "Failed to save blockchain cache";
     return false;
@@ -520,6 +605,7 @@ bool Blockchain::storeCache() {
 bool Blockchain::deinit() {
   storeCache();
   storeBlockchainIndices();
+  storeHeaderIndex();
   assert(m_messageQueueList.empty());
   return true;
 }
@@ -528,6 +614,7 @@ bool Blockchain::resetAndSetGenesisBlock(const Block& b) {
   std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   m_blocks.clear();
   m_blockIndex.clear();
+  m_headerIndex.clear();
   m_transactionMap.clear();
 
   m_spent_keys.clear();
@@ -546,24 +633,24 @@ bool Blockchain::resetAndSetGenesisBlock(const Block& b) {
 
 Crypto::Hash Blockchain::getTailId(uint32_t& height) {
   assert(!m_blocks.empty());
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   height = getCurrentBlockchainHeight() - 1;
   return getTailId();
 }
 
 Crypto::Hash Blockchain::getTailId() {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   return m_blocks.empty() ? NULL_HASH : m_blockIndex.getTailId();
 }
 
 std::vector<Crypto::Hash> Blockchain::buildSparseChain() {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   assert(m_blockIndex.size() != 0);
   return doBuildSparseChain(m_blockIndex.getTailId());
 }
 
 std::vector<Crypto::Hash> Blockchain::buildSparseChain(const Crypto::Hash& startBlockId) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   assert(haveBlock(startBlockId));
   return doBuildSparseChain(startBlockId);
 }
@@ -600,18 +687,18 @@ std::vector<Crypto::Hash> Blockchain::doBuildSparseChain(const Crypto::Hash& sta
 }
 
 Crypto::Hash Blockchain::getBlockIdByHeight(uint32_t height) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   assert(height < m_blockIndex.size());
   return m_blockIndex.getBlockId(height);
 }
 
 bool Blockchain::getBlockByHash(const Crypto::Hash& blockHash, Block& b) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
 
   uint32_t height = 0;
 
   if (m_blockIndex.getBlockHeight(blockHash, height)) {
-    b = m_blocks[height].bl;
+    m_blocks.load(height, b);
     return true;
   }
 
@@ -627,12 +714,12 @@ bool Blockchain::getBlockByHash(const Crypto::Hash& blockHash, Block& b) {
 }
 
 bool Blockchain::getBlockHeight(const Crypto::Hash& blockId, uint32_t& blockHeight) {
-  std::lock_guard<decltype(m_blockchain_lock)> lock(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lock(m_blockchain_lock);
   return m_blockIndex.getBlockHeight(blockId, blockHeight);
 }
 
 difficulty_type Blockchain::getDifficultyForNextBlock() {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   std::vector<uint64_t> timestamps;
   std::vector<difficulty_type> commulative_difficulties;
   size_t difficultyBlocksCount;
@@ -646,8 +733,8 @@ difficulty_type Blockchain::getDifficultyForNextBlock() {
   }
 
   for (; offset < m_blocks.size(); offset++) {
-    timestamps.push_back(m_blocks[offset].bl.timestamp);
-    commulative_difficulties.push_back(m_blocks[offset].cumulative_difficulty);
+    timestamps.push_back(m_headerIndex.timestamp(static_cast<uint32_t>(offset)));
+    commulative_difficulties.push_back(m_headerIndex.cumulativeDifficulty(static_cast<uint32_t>(offset)));
   }
 
   if (m_blocks.size() <= parameters::TycheCash_HARDFORK_HEIGHT_V2) {
@@ -668,11 +755,11 @@ difficulty_type Blockchain::getDifficultyForNextBlock() {
 }
 
 uint64_t Blockchain::getCoinsInCirculation() {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   if (m_blocks.empty()) {
     return 0;
   } else {
-    return m_blocks.back().already_generated_coins;
+    return m_headerIndex.alreadyGeneratedCoins(m_headerIndex.size() - 1);
   }
 }
 
@@ -786,7 +873,7 @@ difficulty_type Blockchain::get_next_difficulty_for_alternative_chain(const std:
   else
 	  difficultyBlocksCount = static_cast<uint64_t>(m_currency.difficultyBlocksCountV5());
   if (alt_chain.size() < difficultyBlocksCount) {
-    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+    Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
     size_t main_chain_stop_offset = alt_chain.size() ? alt_chain.front()->second.height : bei.height;
     size_t main_chain_count = difficultyBlocksCount - std::min(difficultyBlocksCount, alt_chain.size());
     main_chain_count = std::min(main_chain_count, main_chain_stop_offset);
@@ -795,8 +882,9 @@ difficulty_type Blockchain::get_next_difficulty_for_alternative_chain(const std:
     if (!main_chain_start_offset)
       ++main_chain_start_offset; //skip genesis block
     for (; main_chain_start_offset < main_chain_stop_offset; ++main_chain_start_offset) {
-      timestamps.push_back(m_blocks[main_chain_start_offset].bl.timestamp);
-      commulative_difficulties.push_back(m_blocks[main_chain_start_offset].cumulative_difficulty);
+      std::shared_ptr<const BlockEntry> block = m_blocks.get(main_chain_start_offset);
+      timestamps.push_back(block->bl.timestamp);
+      commulative_difficulties.push_back(block->cumulative_difficulty);
     }
 
     if (!((alt_chain.size() + timestamps.size()) <= difficultyBlocksCount)) {
@@ -912,7 +1000,7 @@ bool Blockchain::validate_miner_transaction(const Block& b, uint32_t height, siz
 }
 
 bool Blockchain::getBackwardBlocksSize(size_t from_height, std::vector<size_t>& sz, size_t count) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   if (!(from_height < m_blocks.size())) {
     logger(ERROR, BRIGHT_RED)
       << "Internal error: get_backward_blocks_sizes called with from_height="
@@ -921,14 +1009,14 @@ bool Blockchain::getBackwardBlocksSize(size_t from_height, std::vector<size_t>&
   }
   size_t start_offset = (from_height + 1) - std::min((from_height + 1), count);
   for (size_t i = start_offset; i != from_height + 1; i++) {
-    sz.push_back(m_blocks[i].block_cumulative_size);
+    sz.push_back(m_headerIndex.blockCumulativeSize(static_cast<uint32_t>(i)));
   }
 
   return true;
 }
 
 bool Blockchain::get_last_n_blocks_sizes(std::vector<size_t>& sz, size_t count) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   if (!m_blocks.size()) {
     return true;
   }
@@ -944,12 +1032,12 @@ bool Blockchain::complete_timestamps_vector(uint64_t start_top_height, std::vect
   if (timestamps.size() >= m_currency.timestampCheckWindow())
     return true;
 
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   size_t need_elements = m_currency.timestampCheckWindow() - timestamps.size();
   if (!(start_top_height < m_blocks.size())) { logger(ERROR, BRIGHT_RED) << "internal error: passed start_height = " << start_top_height << " not less then m_blocks.size()=" << m_blocks.size(); return false; }
   size_t stop_offset = start_top_height > need_elements ? start_top_height - need_elements : 0;
   do {
-    timestamps.push_back(m_blocks[start_top_height].bl.timestamp);
+    timestamps.push_back(m_headerIndex.timestamp(static_cast<uint32_t>(start_top_height)));
     if (start_top_height == 0)
       break;
     --start_top_height;
@@ -1008,8 +1096,7 @@ bool Blockchain::handle_alternative_block(const Block& b, const Crypto::Hash& id
     if (alt_chain.size()) {
       //make sure that it has right connection to main chain
       if (!(m_blocks.size() > alt_chain.front()->second.height)) { logger(ERROR, BRIGHT_RED) << "main blockchain wrong height"; return false; }
-      Crypto::Hash h = NULL_HASH;
-      get_block_hash(m_blocks[alt_chain.front()->second.height - 1].bl, h);
+      Crypto::Hash h = m_headerIndex.hash(alt_chain.front()->second.height - 1);
       if (!(h == alt_chain.front()->second.bl.previousBlockHash)) { logger(ERROR, BRIGHT_RED) << "alternative chain have wrong connection to main chain"; return false; }
       complete_timestamps_vector(alt_chain.front()->second.height - 1, timestamps);
     } else {
@@ -1044,7 +1131,10 @@ bool Blockchain::handle_alternative_block(const Block& b, const Crypto::Hash& id
     difficulty_type current_diff = get_next_difficulty_for_alternative_chain(alt_chain, bei);
     if (!(current_diff)) { logger(ERROR, BRIGHT_RED) << "!!!!!!! DIFFICULTY OVERHEAD !!!!!!!"; return false; }
     Crypto::Hash proof_of_work = NULL_HASH;
-    if (!m_currency.checkProofOfWork(m_cn_context, bei.bl, current_diff, proof_of_work)) {
+    bool proofOfWorkValid = takePrecomputedProofOfWork(id, proof_of_work) ?
+      check_hash(proof_of_work, current_diff) :
+      m_currency.checkProofOfWork(m_cn_context, bei.bl, current_diff, proof_of_work);
+    if (!proofOfWorkValid) {
       logger(INFO, BRIGHT_RED) <<
         "Block with id: " << id
         << ENDL << " for alternative chain, have not enough proof of work: " << proof_of_work
@@ -1060,7 +1150,7 @@ bool Blockchain::handle_alternative_block(const Block& b, const Crypto::Hash& id
       return false;
     }
 
-    bei.cumulative_difficulty = alt_chain.size() ? it_prev->second.cumulative_difficulty : m_blocks[mainPrevHeight].cumulative_difficulty;
+    bei.cumulative_difficulty = alt_chain.size() ? it_prev->second.cumulative_difficulty : m_headerIndex.cumulativeDifficulty(mainPrevHeight);
     bei.cumulative_difficulty += current_diff;
 
 #ifdef _DEBUG
@@ -1088,11 +1178,11 @@ bool Blockchain::handle_alternative_block(const Block& b, const Crypto::Hash& id
         bvc.m_verification_failed = true;
       }
       return r;
-    } else if (m_blocks.back().cumulative_difficulty < bei.cumulative_difficulty) //check if difficulty bigger then in main chain
+    } else if (m_headerIndex.cumulativeDifficulty(m_headerIndex.size() - 1) < bei.cumulative_difficulty) //check if difficulty bigger then in main chain
     {
       //do reorganize!
       logger(INFO, BRIGHT_GREEN) <<
-        "###### REORGANIZE on height: " << alt_chain.front()->second.height << " of " << m_blocks.size() - 1 << " with cum_difficulty " << m_blocks.back().cumulative_difficulty
+        "###### REORGANIZE on height: " << alt_chain.front()->second.height << " of " << m_blocks.size() - 1 << " with cum_difficulty " << m_headerIndex.cumulativeDifficulty(m_headerIndex.size() - 1)
         << ENDL << " alternative blockchain size: " << alt_chain.size() << " with cum_difficulty " << bei.cumulative_difficulty;
       bool r = switch_to_alternative_blockchain(alt_chain, false);
       if (r) {
@@ -1124,13 +1214,14 @@ bool Blockchain::handle_alternative_block(const Block& b, const Crypto::Hash& id
 }
 
 bool Blockchain::getBlocks(uint32_t start_offset, uint32_t count, std::list<Block>& blocks, std::list<Transaction>& txs) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   if (start_offset >= m_blocks.size())
     return false;
   for (size_t i = start_offset; i < start_offset + count && i < m_blocks.size(); i++) {
-    blocks.push_back(m_blocks[i].bl);
+    blocks.push_back(Block());
+    m_blocks.load(i, blocks.back());
     std::list<Crypto::Hash> missed_ids;
-    getTransactions(m_blocks[i].bl.transactionHashes, txs, missed_ids);
+    getTransactions(blocks.back().transactionHashes, txs, missed_ids);
     if (!(!missed_ids.size())) { logger(ERROR, BRIGHT_RED) << "have missed transactions in own block in main blockchain"; return false; }
   }
 
@@ -1138,20 +1229,21 @@ bool Blockchain::getBlocks(uint32_t start_offset, uint32_t count, std::list<Bloc
 }
 
 bool Blockchain::getBlocks(uint32_t start_offset, uint32_t count, std::list<Block>& blocks) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   if (start_offset >= m_blocks.size()) {
     return false;
   }
 
   for (uint32_t i = start_offset; i < start_offset + count && i < m_blocks.size(); i++) {
-    blocks.push_back(m_blocks[i].bl);
+    blocks.push_back(Block());
+    m_blocks.load(i, blocks.back());
   }
 
   return true;
 }
 
 bool Blockchain::handleGetObjects(NOTIFY_REQUEST_GET_OBJECTS::request& arg, NOTIFY_RESPONSE_GET_OBJECTS::request& rsp) { //Deprecated. Should be removed with TycheCashProtocolHandler.
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   rsp.current_blockchain_height = getCurrentBlockchainHeight();
   std::list<Block> blocks;
   getBlocks(arg.blocks, blocks, rsp.missed_ids);
@@ -1183,7 +1275,7 @@ bool Blockchain::handleGetObjects(NOTIFY_REQUEST_GET_OBJECTS::request& arg, NOTI
 }
 
 bool Blockchain::getAlternativeBlocks(std::list<Block>& blocks) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   for (auto& alt_bl : m_alternative_chains) {
     blocks.push_back(alt_bl.second.bl);
   }
@@ -1192,48 +1284,38 @@ bool Blockchain::getAlternativeBlocks(std::list<Block>& blocks) {
 }
 
 uint32_t Blockchain::getAlternativeBlocksCount() {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   return static_cast<uint32_t>(m_alternative_chains.size());
 }
 
-bool Blockchain::add_out_to_get_random_outs(std::vector<std::pair<TransactionIndex, uint16_t>>& amount_outs, COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount& result_outs, uint64_t amount, size_t i) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
-  const Transaction& tx = transactionByIndex(amount_outs[i].first).tx;
-  if (!(tx.outputs.size() > amount_outs[i].second)) {
-    logger(ERROR, BRIGHT_RED) << "internal error: in global outs index, transaction out index="
-      << amount_outs[i].second << " more than transaction outputs = " << tx.outputs.size() << ", for tx id = " << getObjectHash(tx); return false;
-  }
-  if (!(tx.outputs[amount_outs[i].second].target.type() == typeid(KeyOutput))) { logger(ERROR, BRIGHT_RED) << "unknown tx out type"; return false; }
-
+bool Blockchain::add_out_to_get_random_outs(const KeyOutputs& amount_outs, COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount& result_outs, uint64_t amount, size_t i) {
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   //check if transaction is unlocked
-  if (!is_tx_spendtime_unlocked(tx.unlockTime))
+  if (!is_tx_spendtime_unlocked(amount_outs.unlockTimes[i]))
     return false;
 
   COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::out_entry& oen = *result_outs.outs.insert(result_outs.outs.end(), COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::out_entry());
   oen.global_amount_index = static_cast<uint32_t>(i);
-  oen.out_key = boost::get<KeyOutput>(tx.outputs[amount_outs[i].second].target).key;
+  oen.out_key = amount_outs.keys[i];
   return true;
 }
 
-size_t Blockchain::find_end_of_allowed_index(const std::vector<std::pair<TransactionIndex, uint16_t>>& amount_outs) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
-  if (amount_outs.empty()) {
+size_t Blockchain::find_end_of_allowed_index(const KeyOutputs& amount_outs) {
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  uint32_t height = getCurrentBlockchainHeight();
+  if (height < m_currency.minedMoneyUnlockWindow()) {
     return 0;
   }
 
-  size_t i = amount_outs.size();
-  do {
-    --i;
-    if (amount_outs[i].first.block + m_currency.minedMoneyUnlockWindow() <= getCurrentBlockchainHeight()) {
-      return i + 1;
-    }
-  } while (i != 0);
-
-  return 0;
+  // outputs are ordered by block, find the first one that is too fresh
+  uint32_t maxBlock = static_cast<uint32_t>(height - m_currency.minedMoneyUnlockWindow());
+  auto end = std::upper_bound(amount_outs.locations.begin(), amount_outs.locations.end(), maxBlock,
+    [](uint32_t block, const std::pair<TransactionIndex, uint16_t>& location) { return block < location.first.block; });
+  return static_cast<size_t>(end - amount_outs.locations.begin());
 }
 
 bool Blockchain::getRandomOutsByAmount(const COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::request& req, COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::response& res) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
 
   for (uint64_t amount : req.amounts) {
     COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount& result_outs = *res.outs.insert(res.outs.end(), COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount());
@@ -1245,7 +1327,7 @@ bool Blockchain::getRandomOutsByAmount(const COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_
       continue;//actually this is strange situation, wallet should use some real outs when it lookup for some mix, so, at least one out for this amount should exist
     }
 
-    std::vector<std::pair<TransactionIndex, uint16_t>>& amount_outs = it->second;
+    const KeyOutputs& amount_outs = it->second;
     //it is not good idea to use top fresh outs, because it increases possibility of transaction canceling on split
     //lets find upper bound of not fresh outs
     size_t up_index_limit = find_end_of_allowed_index(amount_outs);
@@ -1265,7 +1347,7 @@ uint32_t Blockchain::findBlockchainSupplement(const std::vector<Crypto::Hash>& q
   assert(!qblock_ids.empty());
   assert(qblock_ids.back() == m_blockIndex.getBlockId(0));
 
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   uint32_t blockIndex;
   // assert above guarantees that method returns true
   m_blockIndex.findSupplement(qblock_ids, blockIndex);
@@ -1273,17 +1355,14 @@ uint32_t Blockchain::findBlockchainSupplement(const std::vector<Crypto::Hash>& q
 }
 
 uint64_t Blockchain::blockDifficulty(size_t i) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   if (!(i < m_blocks.size())) { logger(ERROR, BRIGHT_RED) << "wrong block index i = " << i << " at Blockchain::block_difficulty()"; return false; }
-  if (i == 0)
-    return m_blocks[i].cumulative_difficulty;
-
-  return m_blocks[i].cumulative_difficulty - m_blocks[i - 1].cumulative_difficulty;
+  return m_headerIndex.difficulty(static_cast<uint32_t>(i));
 }
 
 void Blockchain::print_blockchain(uint64_t start_index, uint64_t end_index) {
   std::stringstream ss;
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   if (start_index >= m_blocks.size()) {
     logger(INFO, BRIGHT_WHITE) <<
       "Wrong starter index set: " << start_index << ", expected max index " << m_blocks.size() - 1;
@@ -1291,9 +1370,10 @@ void Blockchain::print_blockchain(uint64_t start_index, uint64_t end_index) {
   }
 
   for (size_t i = start_index; i != m_blocks.size() && i != end_index; i++) {
-    ss << "height " << i << ", timestamp " << m_blocks[i].bl.timestamp << ", cumul_dif " << m_blocks[i].cumulative_difficulty << ", cumul_size " << m_blocks[i].block_cumulative_size
-      << "\nid\t\t" << get_block_hash(m_blocks[i].bl)
-      << "\ndifficulty\t\t" << blockDifficulty(i) << ", nonce " << m_blocks[i].bl.nonce << ", tx_count " << m_blocks[i].bl.transactionHashes.size() << ENDL;
+    std::shared_ptr<const BlockEntry> block = m_blocks.get(i);
+    ss << "height " << i << ", timestamp " << block->bl.timestamp << ", cumul_dif " << block->cumulative_difficulty << ", cumul_size " << block->block_cumulative_size
+      << "\nid\t\t" << get_block_hash(block->bl)
+      << "\ndifficulty\t\t" << blockDifficulty(i) << ", nonce " << block->bl.nonce << ", tx_count " << block->bl.transactionHashes.size() << ENDL;
   }
   logger(DEBUGGING) <<
     "Current blockchain:" << ENDL << ss.str();
@@ -1303,7 +1383,7 @@ void Blockchain::print_blockchain(uint64_t start_index, uint64_t end_index) {
 
 void Blockchain::print_blockchain_index() {
   std::stringstream ss;
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
 
   std::vector<Crypto::Hash> blockIds = m_blockIndex.getBlockIds(0, std::numeric_limits<uint32_t>::max());
   logger(INFO, BRIGHT_WHITE) << "Current blockchain index:";
@@ -1317,13 +1397,13 @@ void Blockchain::print_blockchain_index() {
 
 void Blockchain::print_blockchain_outs(const std::string& file) {
   std::stringstream ss;
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   for (const outputs_container::value_type& v : m_outputs) {
-    const std::vector<std::pair<TransactionIndex, uint16_t>>& vals = v.second;
+    const std::vector<std::pair<TransactionIndex, uint16_t>>& vals = v.second.locations;
     if (!vals.empty()) {
       ss << "amount: " << v.first << ENDL;
       for (size_t i = 0; i != vals.size(); i++) {
-        ss << "\t" << getObjectHash(transactionByIndex(vals[i].first).tx) << ": " << vals[i].second << ENDL;
+        ss << "\t" << getObjectHash(transactionByIndex(vals[i].first)->tx) << ": " << vals[i].second << ENDL;
       }
     }
   }
@@ -1343,7 +1423,7 @@ std::vector<Crypto::Hash> Blockchain::findBlockchainSupplement(const std::vector
   assert(!remoteBlockIds.empty());
   assert(remoteBlockIds.back() == m_blockIndex.getBlockId(0));
 
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   totalBlockCount = getCurrentBlockchainHeight();
   startBlockIndex = findBlockchainSupplement(remoteBlockIds);
 
@@ -1351,7 +1431,7 @@ std::vector<Crypto::Hash> Blockchain::findBlockchainSupplement(const std::vector
 }
 
 bool Blockchain::haveBlock(const Crypto::Hash& id) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   if (m_blockIndex.hasBlock(id))
     return true;
 
@@ -1362,30 +1442,36 @@ bool Blockchain::haveBlock(const Crypto::Hash& id) {
 }
 
 size_t Blockchain::getTotalTransactions() {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   return m_transactionMap.size();
 }
 
+void Blockchain::getBlockCacheStatistics(uint64_t& hits, uint64_t& misses) {
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  hits = m_blocks.cacheHits();
+  misses = m_blocks.cacheMisses();
+}
+
 bool Blockchain::getTransactionOutputGlobalIndexes(const Crypto::Hash& tx_id, std::vector<uint32_t>& indexs) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   auto it = m_transactionMap.find(tx_id);
   if (it == m_transactionMap.end()) {
     logger(WARNING, YELLOW) << "warning: get_tx_outputs_gindexs failed to find transaction with id = " << tx_id;
     return false;
   }
 
-  const TransactionEntry& tx = transactionByIndex(it->second);
-  if (!(tx.m_global_output_indexes.size())) { logger(ERROR, BRIGHT_RED) << "internal error: global indexes for transaction " << tx_id << " is empty"; return false; }
-  indexs.resize(tx.m_global_output_indexes.size());
-  for (size_t i = 0; i < tx.m_global_output_indexes.size(); ++i) {
-    indexs[i] = tx.m_global_output_indexes[i];
+  std::shared_ptr<const TransactionEntry> tx = transactionByIndex(it->second);
+  if (!(tx->m_global_output_indexes.size())) { logger(ERROR, BRIGHT_RED) << "internal error: global indexes for transaction " << tx_id << " is empty"; return false; }
+  indexs.resize(tx->m_global_output_indexes.size());
+  for (size_t i = 0; i < tx->m_global_output_indexes.size(); ++i) {
+    indexs[i] = tx->m_global_output_indexes[i];
   }
 
   return true;
 }
 
 bool Blockchain::get_out_by_msig_gindex(uint64_t amount, uint64_t gindex, MultisignatureOutput& out) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   auto it = m_multisignatureOutputs.find(amount);
   if (it == m_multisignatureOutputs.end()) {
     return false;
@@ -1396,7 +1482,8 @@ bool Blockchain::get_out_by_msig_gindex(uint64_t amount, uint64_t gindex, Multis
   }
 
   auto msigUsage = it->second[gindex];
-  auto& targetOut = transactionByIndex(msigUsage.transactionIndex).tx.outputs[msigUsage.outputIndex].target;
+  std::shared_ptr<const TransactionEntry> tx = transactionByIndex(msigUsage.transactionIndex);
+  auto& targetOut = tx->tx.outputs[msigUsage.outputIndex].target;
   if (targetOut.type() != typeid(MultisignatureOutput)) {
     return false;
   }
@@ -1408,7 +1495,7 @@ bool Blockchain::get_out_by_msig_gindex(uint64_t amount, uint64_t gindex, Multis
 
 
 bool Blockchain::checkTransactionInputs(const Transaction& tx, uint32_t& max_used_block_height, Crypto::Hash& max_used_block_id, BlockInfo* tail) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
 
   if (tail)
     tail->id = getTailId(tail->height);
@@ -1416,10 +1503,43 @@ bool Blockchain::checkTransactionInputs(const Transaction& tx, uint32_t& max_use
   bool res = checkTransactionInputs(tx, &max_used_block_height);
   if (!res) return false;
   if (!(max_used_block_height < m_blocks.size())) { logger(ERROR, BRIGHT_RED) << "internal error: max used block index=" << max_used_block_height << " is not less then blockchain size = " << m_blocks.size(); return false; }
-  get_block_hash(m_blocks[max_used_block_height].bl, max_used_block_id);
+  max_used_block_id = m_headerIndex.hash(max_used_block_height);
   return true;
 }
 
+void Blockchain::checkTransactionsInputs(const std::vector<const Transaction*>& transactions, std::vector<BlockInfo>& maxUsedBlocks, std::vector<bool>& valid) {
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+
+  maxUsedBlocks.assign(transactions.size(), BlockInfo());
+  valid.assign(transactions.size(), false);
+
+  // outputs are resolved one transaction after another, ring signatures of all of them are verified at once
+  std::vector<RingSignatureCheck> ringSignatureChecks;
+  std::vector<size_t> checkTransactions;
+  for (size_t i = 0; i < transactions.size(); ++i) {
+    const size_t checksCount = ringSignatureChecks.size();
+    if (!checkTransactionInputs(*transactions[i], &maxUsedBlocks[i].height, &ringSignatureChecks)) {
+      ringSignatureChecks.resize(checksCount);
+      continue;
+    }
+
+    if (!(maxUsedBlocks[i].height < m_blocks.size())) { logger(ERROR, BRIGHT_RED) << "internal error: max used block index=" << maxUsedBlocks[i].height << " is not less then blockchain size = " << m_blocks.size(); continue; }
+    maxUsedBlocks[i].id = m_headerIndex.hash(maxUsedBlocks[i].height);
+    valid[i] = true;
+    checkTransactions.resize(ringSignatureChecks.size(), i);
+  }
+
+  std::vector<uint8_t> validSignatures;
+  checkRingSignatures(ringSignatureChecks, validSignatures);
+  for (size_t i = 0; i < ringSignatureChecks.size(); ++i) {
+    if (!validSignatures[i] && valid[checkTransactions[i]]) {
+      logger(INFO, BRIGHT_WHITE) << "Failed to check ring signature for tx " << getObjectHash(*transactions[checkTransactions[i]]);
+      valid[checkTransactions[i]] = false;
+      maxUsedBlocks[checkTransactions[i]].clear();
+    }
+  }
+}
+
 bool Blockchain::haveTransactionKeyImagesAsSpent(const Transaction &tx) {
   for (const auto& in : tx.inputs) {
     if (in.type() == typeid(KeyInput)) {
@@ -1432,12 +1552,12 @@ bool Blockchain::haveTransactionKeyImagesAsSpent(const Transaction &tx) {
   return false;
 }
 
-bool Blockchain::checkTransactionInputs(const Transaction& tx, uint32_t* pmax_used_block_height) {
+bool Blockchain::checkTransactionInputs(const Transaction& tx, uint32_t* pmax_used_block_height, std::vector<RingSignatureCheck>* deferredChecks) {
   Crypto::Hash tx_prefix_hash = getObjectHash(*static_cast<const TransactionPrefix*>(&tx));
-  return checkTransactionInputs(tx, tx_prefix_hash, pmax_used_block_height);
+  return checkTransactionInputs(tx, tx_prefix_hash, pmax_used_block_height, deferredChecks);
 }
 
-bool Blockchain::checkTransactionInputs(const Transaction& tx, const Crypto::Hash& tx_prefix_hash, uint32_t* pmax_used_block_height) {
+bool Blockchain::checkTransactionInputs(const Transaction& tx, const Crypto::Hash& tx_prefix_hash, uint32_t* pmax_used_block_height, std::vector<RingSignatureCheck>* deferredChecks) {
   size_t inputIndex = 0;
   if (pmax_used_block_height) {
     *pmax_used_block_height = 0;
@@ -1456,7 +1576,7 @@ bool Blockchain::checkTransactionInputs(const Transaction& tx, const Crypto::Has
         return false;
       }
 
-      if (!check_tx_input(in_to_key, tx_prefix_hash, tx.signatures[inputIndex], pmax_used_block_height)) {
+      if (!check_tx_input(in_to_key, tx_prefix_hash, tx.signatures[inputIndex], pmax_used_block_height, deferredChecks)) {
         logger(INFO, BRIGHT_WHITE) <<
           "Failed to check ring signature for tx " << transactionHash;
         return false;
@@ -1498,37 +1618,31 @@ bool Blockchain::is_tx_spendtime_unlocked(uint64_t unlock_time) {
   return false;
 }
 
-bool Blockchain::check_tx_input(const KeyInput& txin, const Crypto::Hash& tx_prefix_hash, const std::vector<Crypto::Signature>& sig, uint32_t* pmax_related_block_height) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+bool Blockchain::check_tx_input(const KeyInput& txin, const Crypto::Hash& tx_prefix_hash, const std::vector<Crypto::Signature>& sig, uint32_t* pmax_related_block_height, std::vector<RingSignatureCheck>* deferredChecks) {
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
 
   struct outputs_visitor {
-    std::vector<const Crypto::PublicKey *>& m_results_collector;
+    std::vector<Crypto::PublicKey>& m_results_collector;
     Blockchain& m_bch;
     LoggerRef logger;
-    outputs_visitor(std::vector<const Crypto::PublicKey *>& results_collector, Blockchain& bch, ILogger& logger) :m_results_collector(results_collector), m_bch(bch), logger(logger, "outputs_visitor") {
+    outputs_visitor(std::vector<Crypto::PublicKey>& results_collector, Blockchain& bch, ILogger& logger) :m_results_collector(results_collector), m_bch(bch), logger(logger, "outputs_visitor") {
     }
 
-    bool handle_output(const Transaction& tx, const TransactionOutput& out, size_t transactionOutputIndex) {
+    bool handle_output(const TransactionIndex& transactionIndex, uint16_t transactionOutputIndex, const Crypto::PublicKey& key, uint64_t unlockTime) {
       //check tx unlock time
-      if (!m_bch.is_tx_spendtime_unlocked(tx.unlockTime)) {
+      if (!m_bch.is_tx_spendtime_unlocked(unlockTime)) {
         logger(INFO, BRIGHT_WHITE) <<
-          "One of outputs for one of inputs have wrong tx.unlockTime = " << tx.unlockTime;
+          "One of outputs for one of inputs have wrong tx.unlockTime = " << unlockTime;
         return false;
       }
 
-      if (out.target.type() != typeid(KeyOutput)) {
-        logger(INFO, BRIGHT_WHITE) <<
-          "Output have wrong type id, which=" << out.target.which();
-        return false;
-      }
-
-      m_results_collector.push_back(&boost::get<KeyOutput>(out.target).key);
+      m_results_collector.push_back(key);
       return true;
     }
   };
 
   //check ring signature
-  std::vector<const Crypto::PublicKey *> output_keys;
+  std::vector<Crypto::PublicKey> output_keys;
   outputs_visitor vi(output_keys, *this, logger.getLogger());
   if (!scanOutputKeysForIndexes(txin, vi, pmax_related_block_height)) {
     logger(INFO, BRIGHT_WHITE) <<
@@ -1557,7 +1671,19 @@ bool Blockchain::check_tx_input(const KeyInput& txin, const Crypto::Hash& tx_pre
     return false;
   }
 
-  return Crypto::check_ring_signature(tx_prefix_hash, txin.keyImage, output_keys, sig.data());
+  if (deferredChecks != nullptr) {
+    RingSignatureCheck check = { tx_prefix_hash, txin.keyImage, std::move(output_keys), sig };
+    deferredChecks->push_back(std::move(check));
+    return true;
+  }
+
+  std::vector<const Crypto::PublicKey*> output_key_ptrs;
+  output_key_ptrs.reserve(output_keys.size());
+  for (const Crypto::PublicKey& key : output_keys) {
+    output_key_ptrs.push_back(&key);
+  }
+
+  return Crypto::check_ring_signature(tx_prefix_hash, txin.keyImage, output_key_ptrs, sig.data());
 }
 
 uint64_t Blockchain::get_adjusted_time() {
@@ -1575,7 +1701,7 @@ bool Blockchain::check_block_timestamp_main(const Block& b) {
   std::vector<uint64_t> timestamps;
   size_t offset = m_blocks.size() <= m_currency.timestampCheckWindow() ? 0 : m_blocks.size() - m_currency.timestampCheckWindow();
   for (; offset != m_blocks.size(); ++offset) {
-    timestamps.push_back(m_blocks[offset].bl.timestamp);
+    timestamps.push_back(m_headerIndex.timestamp(static_cast<uint32_t>(offset)));
   }
 
   return check_block_timestamp(std::move(timestamps), b);
@@ -1681,8 +1807,14 @@ bool Blockchain::addNewBlock(const Block& bl_, block_verification_context& bvc)
   return add_result;
 }
 
-const Blockchain::TransactionEntry& Blockchain::transactionByIndex(TransactionIndex index) {
-  return m_blocks[index.block].transactions[index.transaction];
+std::shared_ptr<const Blockchain::TransactionEntry> Blockchain::transactionByIndex(TransactionIndex index) {
+  std::shared_ptr<const BlockEntry> block = m_blocks.get(index.block);
+  return std::shared_ptr<const TransactionEntry>(block, &block->transactions[index.transaction]);
+}
+
+Crypto::Hash Blockchain::getTransactionHash(const TransactionIndex& index) {
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  return getObjectHash(transactionByIndex(index)->tx);
 }
 
 bool Blockchain::pushBlock(const Block& blockData, block_verification_context& bvc) {
@@ -1747,6 +1879,13 @@ bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction
       bvc.m_verification_failed = true;
       return false;
     }
+  } else if (takePrecomputedProofOfWork(blockHash, proof_of_work)) {
+    if (!check_hash(proof_of_work, currentDifficulty)) {
+      logger(INFO, BRIGHT_WHITE) <<
+        "Block " << blockHash << ", has too weak proof of work: " << proof_of_work << ", expected difficulty: " << currentDifficulty;
+      bvc.m_verification_failed = true;
+      return false;
+    }
   } else {
     if (!m_currency.checkProofOfWork(m_cn_context, blockData, currentDifficulty, proof_of_work)) {
       logger(INFO, BRIGHT_WHITE) <<
@@ -1777,6 +1916,8 @@ bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction
   size_t coinbase_blob_size = getObjectBinarySize(blockData.baseTransaction);
   size_t cumulative_block_size = coinbase_blob_size;
   uint64_t fee_summary = 0;
+  // Ring signatures are collected while inputs are checked and verified in parallel once all transactions are processed
+  std::vector<RingSignatureCheck> ringSignatureChecks;
   for (size_t i = 0; i < transactions.size(); ++i) {
     const Crypto::Hash& tx_id = blockData.transactionHashes[i];
     block.transactions.resize(block.transactions.size() + 1);
@@ -1786,7 +1927,7 @@ bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction
 
     blob_size = toBinaryArray(block.transactions.back().tx).size();
     fee = getInputAmount(block.transactions.back().tx) - getOutputAmount(block.transactions.back().tx);
-    if (!checkTransactionInputs(block.transactions.back().tx)) {
+    if (!checkTransactionInputs(block.transactions.back().tx, nullptr, &ringSignatureChecks)) {
       logger(INFO, BRIGHT_WHITE) <<
         "Block " << blockHash << " has at least one transaction with wrong inputs: " << tx_id;
       bvc.m_verification_failed = true;
@@ -1803,6 +1944,17 @@ bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction
     fee_summary += fee;
   }
 
+  auto signaturesCheckStart = std::chrono::steady_clock::now();
+  if (!checkRingSignatures(ringSignatureChecks)) {
+    logger(INFO, BRIGHT_WHITE) <<
+      "Block " << blockHash << " has at least one transaction with wrong ring signature";
+    bvc.m_verification_failed = true;
+    popTransactions(block, minerTransactionHash);
+    return false;
+  }
+
+  auto signatures_checking_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - signaturesCheckStart).count();
+
   if (!checkCumulativeBlockSize(blockHash, cumulative_block_size, m_blocks.size())) {
     bvc.m_verification_failed = true;
     return false;
@@ -1810,7 +1962,7 @@ bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction
 
   int64_t emissionChange = 0;
   uint64_t reward = 0;
-  uint64_t already_generated_coins = m_blocks.empty() ? 0 : m_blocks.back().already_generated_coins;
+  uint64_t already_generated_coins = m_headerIndex.empty() ? 0 : m_headerIndex.alreadyGeneratedCoins(m_headerIndex.size() - 1);
   if (!validate_miner_transaction(blockData, static_cast<uint32_t>(m_blocks.size()), cumulative_block_size, already_generated_coins, fee_summary, reward, emissionChange)) {
     logger(INFO, BRIGHT_WHITE) << "Block " << blockHash << " has invalid miner transaction";
     bvc.m_verification_failed = true;
@@ -1823,7 +1975,7 @@ bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction
   block.cumulative_difficulty = currentDifficulty;
   block.already_generated_coins = already_generated_coins + emissionChange;
   if (m_blocks.size() > 0) {
-    block.cumulative_difficulty += m_blocks.back().cumulative_difficulty;
+    block.cumulative_difficulty += m_headerIndex.cumulativeDifficulty(m_headerIndex.size() - 1);
   }
 
   pushBlock(block);
@@ -1836,7 +1988,7 @@ bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction
     << ENDL << "HEIGHT " << block.height << ", difficulty:\t" << currentDifficulty
     << ENDL << "block reward: " << m_currency.formatAmount(reward) << ", fee = " << m_currency.formatAmount(fee_summary)
     << ", coinbase_blob_size: " << coinbase_blob_size << ", cumulative size: " << cumulative_block_size
-    << ", " << block_processing_time << "(" << target_calculating_time << "/" << longhash_calculating_time << ")ms";
+    << ", " << block_processing_time << "(" << target_calculating_time << "/" << longhash_calculating_time << "/" << signatures_checking_time << ")ms";
 
   bvc.m_added_to_main_chain = true;
 
@@ -1845,16 +1997,157 @@ bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction
   return true;
 }
 
+bool Blockchain::checkRingSignatures(const std::vector<RingSignatureCheck>& checks) {
+  // signatures are checked in batches, one per thread, sharing field inversions inside of a batch
+  const size_t batchesCount = std::min(checks.size(), m_verificationPool->threadCount());
+  std::atomic<bool> valid(true);
+  m_verificationPool->parallelFor(batchesCount, [&checks, &valid, batchesCount](size_t batch) {
+    const size_t begin = checks.size() * batch / batchesCount;
+    const size_t end = checks.size() * (batch + 1) / batchesCount;
+    if (valid && !checkRingSignatures(checks, begin, end)) {
+      valid = false;
+    }
+  });
+
+  return valid;
+}
+
+void Blockchain::checkRingSignatures(const std::vector<RingSignatureCheck>& checks, std::vector<uint8_t>& valid) {
+  valid.assign(checks.size(), 0);
+  const size_t batchesCount = std::min(checks.size(), m_verificationPool->threadCount());
+  m_verificationPool->parallelFor(batchesCount, [&checks, &valid, batchesCount](size_t batch) {
+    const size_t begin = checks.size() * batch / batchesCount;
+    const size_t end = checks.size() * (batch + 1) / batchesCount;
+    if (checkRingSignatures(checks, begin, end)) {
+      std::fill(valid.begin() + begin, valid.begin() + end, 1);
+      return;
+    }
+
+    // some signature of the batch is invalid, find out which ones
+    for (size_t i = begin; i < end; ++i) {
+      valid[i] = checkRingSignatures(checks, i, i + 1) ? 1 : 0;
+    }
+  });
+}
+
+bool Blockchain::checkRingSignatures(const std::vector<RingSignatureCheck>& checks, size_t begin, size_t end) {
+  std::vector<std::vector<const Crypto::PublicKey*>> outputKeys(end - begin);
+  std::vector<Crypto::RingSignatureBatchEntry> entries(end - begin);
+  for (size_t i = begin; i < end; ++i) {
+    const RingSignatureCheck& check = checks[i];
+    for (const Crypto::PublicKey& key : check.outputKeys) {
+      outputKeys[i - begin].push_back(&key);
+    }
+
+    Crypto::RingSignatureBatchEntry& entry = entries[i - begin];
+    entry.prefix_hash = &check.prefixHash;
+    entry.image = &check.keyImage;
+    entry.pubs = outputKeys[i - begin].data();
+    entry.pubs_count = outputKeys[i - begin].size();
+    entry.sig = check.signatures.data();
+  }
+
+  return Crypto::check_ring_signatures(entries);
+}
+
+void Blockchain::setVerificationThreadsCount(size_t threadsCount) {
+  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  m_verificationPool.reset(new Tools::ThreadPool(threadsCount));
+
+  std::lock_guard<std::mutex> contextsLock(m_proofOfWorkContextsLock);
+  m_proofOfWorkPool.reset(new Tools::ThreadPool(threadsCount));
+}
+
+void Blockchain::parallelFor(size_t count, const std::function<void(size_t)>& func) {
+  m_verificationPool->parallelFor(count, func);
+}
+
+void Blockchain::precomputeProofOfWork(const std::vector<const Block*>& blocks) {
+  // blocks in the checkpoint zone are checked against checkpoints, their proof of work is never computed
+  std::vector<const Block*> pending;
+  for (const Block* block : blocks) {
+    const auto& inputs = block->baseTransaction.inputs;
+    if (inputs.size() == 1 && inputs[0].type() == typeid(BaseInput) &&
+        !m_checkpoints.is_in_checkpoint_zone(boost::get<BaseInput>(inputs[0]).blockIndex)) {
+      pending.push_back(block);
+    }
+  }
+
+  if (pending.empty()) {
+    return;
+  }
+
+  std::vector<Crypto::Hash> blockHashes(pending.size());
+  std::vector<Crypto::Hash> proofsOfWork(pending.size());
+  std::vector<uint8_t> computed(pending.size(), 0);
+
+  {
+    std::lock_guard<std::mutex> contextsLock(m_proofOfWorkContextsLock);
+    // a context owns a 2 MiB scratchpad, so blocks are hashed in batches, one batch and one context per thread
+    const size_t batchesCount = std::min(pending.size(), m_proofOfWorkPool->threadCount());
+    while (m_proofOfWorkContexts.size() < batchesCount) {
+      m_proofOfWorkContexts.emplace_back(new Crypto::cn_context());
+    }
+
+    m_proofOfWorkPool->parallelFor(batchesCount, [&](size_t batch) {
+      Crypto::cn_context& context = *m_proofOfWorkContexts[batch];
+      const size_t begin = pending.size() * batch / batchesCount;
+      const size_t end = pending.size() * (batch + 1) / batchesCount;
+      for (size_t i = begin; i < end; ++i) {
+        blockHashes[i] = get_block_hash(*pending[i]);
+        computed[i] = get_block_longhash(context, *pending[i], proofsOfWork[i]) ? 1 : 0;
+      }
+    });
+  }
+
+  std::lock_guard<std::mutex> lk(m_precomputedProofOfWorkLock);
+  if (m_precomputedProofOfWork.size() + pending.size() > MAX_PRECOMPUTED_PROOFS_OF_WORK) {
+    m_precomputedProofOfWork.clear();
+  }
+
+  for (size_t i = 0; i < pending.size(); ++i) {
+    if (computed[i]) {
+      m_precomputedProofOfWork[blockHashes[i]] = proofsOfWork[i];
+    }
+  }
+}
+
+bool Blockchain::takePrecomputedProofOfWork(const Crypto::Hash& blockHash, Crypto::Hash& proofOfWork) {
+  std::lock_guard<std::mutex> lk(m_precomputedProofOfWorkLock);
+  auto it = m_precomputedProofOfWork.find(blockHash);
+  if (it == m_precomputedProofOfWork.end()) {
+    return false;
+  }
+
+  proofOfWork = it->second;
+  m_precomputedProofOfWork.erase(it);
+  return true;
+}
+
+void Blockchain::setCacheCheckpointInterval(uint32_t interval) {
+  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  m_cacheCheckpointInterval = interval;
+}
+
 bool Blockchain::pushBlock(BlockEntry& block) {
   Crypto::Hash blockHash = get_block_hash(block.bl);
 
   m_blocks.push_back(block);
   m_blockIndex.push(blockHash);
+  m_headerIndex.push(makeHeaderInfo(block, blockHash));
 
   m_timestampIndex.add(block.bl.timestamp, blockHash);
   m_generatedTransactionsIndex.add(block.bl);
 
   assert(m_blockIndex.size() == m_blocks.size());
+  assert(m_headerIndex.size() == m_blocks.size());
+
+  if (m_cacheCheckpointInterval != 0 && m_blocks.size() % m_cacheCheckpointInterval == 0) {
+    logger(INFO, BRIGHT_WHITE) << "Storing blockchain cache checkpoint at height " << m_blocks.size() - 1;
+    storeCache();
+    storeBlockchainIndices();
+    storeHeaderIndex();
+  }
 
   return true;
 }
@@ -1880,8 +2173,58 @@ void Blockchain::popBlock(const Crypto::Hash& blockHash) {
 
   m_blocks.pop_back();
   m_blockIndex.pop();
+  m_headerIndex.pop();
 
   assert(m_blockIndex.size() == m_blocks.size());
+  assert(m_headerIndex.size() == m_blocks.size());
+}
+
+// Precondition: m_blockchain_lock is locked.
+BlockHeaderInfo Blockchain::makeHeaderInfo(const BlockEntry& block, const Crypto::Hash& blockHash) {
+  BlockHeaderInfo header;
+  header.hash = blockHash;
+  header.timestamp = block.bl.timestamp;
+  header.cumulativeDifficulty = block.cumulative_difficulty;
+  header.blockCumulativeSize = block.block_cumulative_size;
+  header.alreadyGeneratedCoins = block.already_generated_coins;
+  header.headerSize = static_cast<uint32_t>(getObjectBinarySize(block.bl) - getObjectBinarySize(block.bl.baseTransaction));
+  header.transactionCount = static_cast<uint32_t>(block.bl.transactionHashes.size() + 1);
+  return header;
+}
+
+// Precondition: m_blockchain_lock is locked.
+void Blockchain::rebuildHeaderIndex(uint32_t startHeight) {
+  std::chrono::steady_clock::time_point timePoint = std::chrono::steady_clock::now();
+  m_headerIndex.resize(std::min(startHeight, m_headerIndex.size()));
+  m_headerIndex.reserve(static_cast<uint32_t>(m_blocks.size()));
+
+  const uint32_t chunkSize = 1000;
+  std::vector<BlockHeaderInfo> headers;
+  std::vector<std::exception_ptr> errors;
+  for (uint32_t chunkStart = m_headerIndex.size(); chunkStart < m_blocks.size(); chunkStart += chunkSize) {
+    const uint32_t chunkEnd = static_cast<uint32_t>(std::min<uint64_t>(chunkStart + chunkSize, m_blocks.size()));
+    headers.resize(chunkEnd - chunkStart);
+    errors.assign(chunkEnd - chunkStart, nullptr);
+    m_verificationPool->parallelFor(chunkEnd - chunkStart, [&](size_t i) {
+      try {
+        uint32_t height = chunkStart + static_cast<uint32_t>(i);
+        headers[i] = makeHeaderInfo(*m_blocks.get(height), m_blockIndex.getBlockId(height));
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    });
+
+    for (uint32_t i = 0; i < chunkEnd - chunkStart; ++i) {
+      if (errors[i]) {
+        std::rethrow_exception(errors[i]);
+      }
+
+      m_headerIndex.push(headers[i]);
+    }
+  }
+
+  std::chrono::duration<double> duration = std::chrono::steady_clock::now() - timePoint;
+  logger(INFO, BRIGHT_WHITE) << "Rebuilding block header index took: " << duration.count();
 }
 
 bool Blockchain::pushTransaction(BlockEntry& block, const Crypto::Hash& transactionHash, TransactionIndex transactionIndex) {
@@ -1930,7 +2273,7 @@ bool Blockchain::pushTransaction(BlockEntry& block, const Crypto::Hash& transact
     if (transaction.tx.outputs[output].target.type() == typeid(KeyOutput)) {
       auto& amountOutputs = m_outputs[transaction.tx.outputs[output].amount];
       transaction.m_global_output_indexes[output] = static_cast<uint32_t>(amountOutputs.size());
-      amountOutputs.push_back(std::make_pair<>(transactionIndex, output));
+      amountOutputs.push(transactionIndex, output, boost::get<KeyOutput>(transaction.tx.outputs[output].target).key, transaction.tx.unlockTime);
     } else if (transaction.tx.outputs[output].target.type() == typeid(MultisignatureOutput)) {
       auto& amountOutputs = m_multisignatureOutputs[transaction.tx.outputs[output].amount];
       transaction.m_global_output_indexes[output] = static_cast<uint32_t>(amountOutputs.size());
@@ -1962,19 +2305,20 @@ void Blockchain::popTransaction(const Transaction& transaction, const Crypto::Ha
         continue;
       }
 
-      if (amountOutputs->second.back().first.block != transactionIndex.block || amountOutputs->second.back().first.transaction != transactionIndex.transaction) {
+      const auto& location = amountOutputs->second.locations.back();
+      if (location.first.block != transactionIndex.block || location.first.transaction != transactionIndex.transaction) {
         logger(ERROR, BRIGHT_RED) <<
           "Blockchain consistency broken - invalid transaction index.";
         continue;
       }
 
-      if (amountOutputs->second.back().second != transaction.outputs.size() - 1 - outputIndex) {
+      if (location.second != transaction.outputs.size() - 1 - outputIndex) {
         logger(ERROR, BRIGHT_RED) <<
           "Blockchain consistency broken - invalid output index.";
         continue;
       }
 
-      amountOutputs->second.pop_back();
+      amountOutputs->second.pop();
       if (amountOutputs->second.empty()) {
         m_outputs.erase(amountOutputs);
       }
@@ -2075,7 +2419,8 @@ bool Blockchain::validateInput(const MultisignatureInput& input, const Crypto::H
     return false;
   }
 
-  const Transaction& outputTransaction = m_blocks[outputIndex.transactionIndex.block].transactions[outputIndex.transactionIndex.transaction].tx;
+  std::shared_ptr<const TransactionEntry> outputEntry = transactionByIndex(outputIndex.transactionIndex);
+  const Transaction& outputTransaction = outputEntry->tx;
   if (!is_tx_spendtime_unlocked(outputTransaction.unlockTime)) {
     logger(DEBUGGING) <<
       "Transaction << " << transactionHash << " contains multisignature input which points to a locked transaction.";
@@ -2111,45 +2456,44 @@ bool Blockchain::validateInput(const MultisignatureInput& input, const Crypto::H
 }
 
 bool Blockchain::getLowerBound(uint64_t timestamp, uint64_t startOffset, uint32_t& height) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
 
   assert(startOffset < m_blocks.size());
 
-  auto bound = std::lower_bound(m_blocks.begin() + startOffset, m_blocks.end(), timestamp - m_currency.blockFutureTimeLimit(),
-    [](const BlockEntry& b, uint64_t timestamp) { return b.bl.timestamp < timestamp; });
+  uint64_t first = m_headerIndex.lowerBound(timestamp - m_currency.blockFutureTimeLimit(), static_cast<uint32_t>(startOffset));
 
-  if (bound == m_blocks.end()) {
+  if (first == m_blocks.size()) {
     return false;
   }
 
-  height = static_cast<uint32_t>(std::distance(m_blocks.begin(), bound));
+  height = static_cast<uint32_t>(first);
   return true;
 }
 
 std::vector<Crypto::Hash> Blockchain::getBlockIds(uint32_t startHeight, uint32_t maxCount) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   return m_blockIndex.getBlockIds(startHeight, maxCount);
 }
 
 bool Blockchain::getBlockContainingTransaction(const Crypto::Hash& txId, Crypto::Hash& blockId, uint32_t& blockHeight) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   auto it = m_transactionMap.find(txId);
   if (it == m_transactionMap.end()) {
     return false;
   } else {
-    blockHeight = m_blocks[it->second.block].height;
+    blockHeight = it->second.block;
     blockId = getBlockIdByHeight(blockHeight);
     return true;
   }
 }
 
 bool Blockchain::getAlreadyGeneratedCoins(const Crypto::Hash& hash, uint64_t& generatedCoins) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
 
   // try to find block in main chain
   uint32_t height = 0;
   if (m_blockIndex.getBlockHeight(hash, height)) {
-    generatedCoins = m_blocks[height].already_generated_coins;
+    generatedCoins = m_headerIndex.alreadyGeneratedCoins(height);
     return true;
   }
 
@@ -2165,12 +2509,12 @@ bool Blockchain::getAlreadyGeneratedCoins(const Crypto::Hash& hash, uint64_t& ge
 }
 
 bool Blockchain::getBlockSize(const Crypto::Hash& hash, size_t& size) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
 
   // try to find block in main chain
   uint32_t height = 0;
   if (m_blockIndex.getBlockHeight(hash, height)) {
-    size = m_blocks[height].block_cumulative_size;
+    size = m_headerIndex.blockCumulativeSize(height);
     return true;
   }
 
@@ -2185,8 +2529,19 @@ bool Blockchain::getBlockSize(const Crypto::Hash& hash, size_t& size) {
   return false;
 }
 
+bool Blockchain::getBlockHeaderInfo(uint32_t height, BlockHeaderInfo& header) {
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  if (height >= m_headerIndex.size()) {
+    logger(DEBUGGING) << "Can't get header of block at height " << height << ", blockchain height is " << m_headerIndex.size();
+    return false;
+  }
+
+  header = m_headerIndex.get(height);
+  return true;
+}
+
 bool Blockchain::getMultisigOutputReference(const MultisignatureInput& txInMultisig, std::pair<Crypto::Hash, size_t>& outputReference) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   MultisignatureOutputsContainer::const_iterator amountIter = m_multisignatureOutputs.find(txInMultisig.amount);
   if (amountIter == m_multisignatureOutputs.end()) {
     logger(DEBUGGING) << "Transaction contains multisignature input with invalid amount.";
@@ -2197,8 +2552,7 @@ bool Blockchain::getMultisigOutputReference(const MultisignatureInput& txInMulti
     return false;
   }
   const MultisignatureOutputUsage& outputIndex = amountIter->second[txInMultisig.outputIndex];
-  const Transaction& outputTransaction = m_blocks[outputIndex.transactionIndex.block].transactions[outputIndex.transactionIndex.transaction].tx;
-  outputReference.first = getObjectHash(outputTransaction);
+  outputReference.first = getObjectHash(transactionByIndex(outputIndex.transactionIndex)->tx);
   outputReference.second = outputIndex.outputIndex;
   return true;
 }
@@ -2207,9 +2561,11 @@ bool Blockchain::storeBlockchainIndices() {
   std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
 
   logger(INFO, BRIGHT_WHITE) << "Saving blockchain indices...";
-  BlockchainIndicesSerializer ser(*this, getTailId(), logger.getLogger());
+  BlockchainIndicesSerializer ser(*this, logger.getLogger());
 
-  if (!storeToBinaryFile(ser, appendPath(m_config_folder, m_currency.blockchinIndicesFileName()))) {
+  // write to a temporary file first, so that interrupted saving doesn't destroy the previous indices
+  const std::string filename = appendPath(m_config_folder, m_currency.blockchinIndicesFileName());
+  if (!storeToBinaryFile(ser, filename + ".tmp") || Tools::replace_file(filename + ".tmp", filename)) {
     logger(ERROR, BRIGHT_RED) << "Failed to save blockchain indices";
     return false;
   }
@@ -2221,54 +2577,96 @@ bool Blockchain::loadBlockchainIndices() {
   std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
 
   logger(INFO, BRIGHT_WHITE) << "Loading blockchain indices for BlockchainExplorer...";
-  BlockchainIndicesSerializer loader(*this, get_block_hash(m_blocks.back().bl), logger.getLogger());
+  BlockchainIndicesSerializer loader(*this, logger.getLogger());
 
   loadFromBinaryFile(loader, appendPath(m_config_folder, m_currency.blockchinIndicesFileName()));
 
   if (!loader.loaded()) {
     logger(WARNING, BRIGHT_YELLOW) << "No actual blockchain indices for BlockchainExplorer found, rebuilding...";
-    std::chrono::steady_clock::time_point timePoint = std::chrono::steady_clock::now();
+    rebuildBlockchainIndices();
+  } else if (loader.height() + 1 < m_blocks.size()) {
+    logger(INFO, BRIGHT_WHITE) << "Blockchain indices are stored at height " << loader.height() << ", replaying " <<
+      m_blocks.size() - loader.height() - 1 << " blocks above it...";
+    rebuildBlockchainIndices(loader.height() + 1);
+  }
+
+  return true;
+}
+
+bool Blockchain::storeHeaderIndex() {
+  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+
+  logger(INFO, BRIGHT_WHITE) << "Saving block header index...";
+  const std::string filename = appendPath(m_config_folder, m_currency.blockHeadersFileName());
+  if (!storeToBinaryFile(m_headerIndex, filename + ".tmp") || Tools::replace_file(filename + ".tmp", filename)) {
+    logger(ERROR, BRIGHT_RED) << "Failed to save block header index";
+    return false;
+  }
 
+  return true;
+}
+
+// Precondition: m_blockchain_lock is locked, m_blockIndex is loaded.
+void Blockchain::loadHeaderIndex() {
+  logger(INFO, BRIGHT_WHITE) << "Loading block header index...";
+  if (!loadFromBinaryFile(m_headerIndex, appendPath(m_config_folder, m_currency.blockHeadersFileName()))) {
+    m_headerIndex.clear();
+  }
+
+  // stored index is usable up to the last block it shares with the main chain, blocks above it are replayed
+  uint32_t height = std::min(m_headerIndex.size(), m_blockIndex.size());
+  if (height == 0 || m_headerIndex.hash(height - 1) != m_blockIndex.getBlockId(height - 1)) {
+    logger(WARNING, BRIGHT_YELLOW) << "No actual block header index found, rebuilding...";
+    rebuildHeaderIndex();
+  } else if (height < m_blocks.size() || height < m_headerIndex.size()) {
+    logger(INFO, BRIGHT_WHITE) << "Block header index is valid up to height " << height - 1 << ", replaying " <<
+      m_blocks.size() - height << " blocks above it...";
+    rebuildHeaderIndex(height);
+  }
+}
+
+void Blockchain::rebuildBlockchainIndices(uint32_t startHeight) {
+  std::chrono::steady_clock::time_point timePoint = std::chrono::steady_clock::now();
+  if (startHeight == 0) {
     m_paymentIdIndex.clear();
     m_timestampIndex.clear();
     m_generatedTransactionsIndex.clear();
+  }
 
-    for (uint32_t b = 0; b < m_blocks.size(); ++b) {
-      if (b % 1000 == 0) {
-        logger(INFO, BRIGHT_WHITE) << "Height " << b << " of " << m_blocks.size();
-      }
-      const BlockEntry& block = m_blocks[b];
-      m_timestampIndex.add(block.bl.timestamp, get_block_hash(block.bl));
-      m_generatedTransactionsIndex.add(block.bl);
-      for (uint16_t t = 0; t < block.transactions.size(); ++t) {
-        const TransactionEntry& transaction = block.transactions[t];
-        m_paymentIdIndex.add(transaction.tx);
-      }
+  for (uint32_t b = startHeight; b < m_blocks.size(); ++b) {
+    if (b % 1000 == 0) {
+      logger(INFO, BRIGHT_WHITE) << "Height " << b << " of " << m_blocks.size();
+    }
+    const BlockEntry& block = m_blocks[b];
+    m_timestampIndex.add(block.bl.timestamp, get_block_hash(block.bl));
+    m_generatedTransactionsIndex.add(block.bl);
+    for (uint16_t t = 0; t < block.transactions.size(); ++t) {
+      const TransactionEntry& transaction = block.transactions[t];
+      m_paymentIdIndex.add(transaction.tx);
     }
-
-    std::chrono::duration<double> duration = std::chrono::steady_clock::now() - timePoint;
-    logger(INFO, BRIGHT_WHITE) << "Rebuilding blockchain indices took: " << duration.count();
   }
-  return true;
+
+  std::chrono::duration<double> duration = std::chrono::steady_clock::now() - timePoint;
+  logger(INFO, BRIGHT_WHITE) << "Rebuilding blockchain indices took: " << duration.count();
 }
 
 bool Blockchain::getGeneratedTransactionsNumber(uint32_t height, uint64_t& generatedTransactions) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   return m_generatedTransactionsIndex.find(height, generatedTransactions);
 }
 
 bool Blockchain::getOrphanBlockIdsByHeight(uint32_t height, std::vector<Crypto::Hash>& blockHashes) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   return m_orthanBlocksIndex.find(height, blockHashes);
 }
 
 bool Blockchain::getBlockIdsByTimestamp(uint64_t timestampBegin, uint64_t timestampEnd, uint32_t blocksNumberLimit, std::vector<Crypto::Hash>& hashes, uint32_t& blocksNumberWithinTimestamps) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   return m_timestampIndex.find(timestampBegin, timestampEnd, blocksNumberLimit, hashes, blocksNumberWithinTimestamps);
 }
 
 bool Blockchain::getTransactionIdsByPaymentId(const Crypto::Hash& paymentId, std::vector<Crypto::Hash>& transactionHashes) {
-  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   return m_paymentIdIndex.find(paymentId, transactionHashes);
 }
 
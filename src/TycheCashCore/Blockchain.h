@@ -5,12 +5,17 @@
 #pragma once
 
 #include <atomic>
+#include <mutex>
+#include <unordered_map>
 
 #include "google/sparse_hash_set"
 #include "google/sparse_hash_map"
 
 #include "Common/ObserverManager.h"
+#include "Common/RecursiveSharedMutex.h"
+#include "Common/ThreadPool.h"
 #include "Common/Util.h"
+#include "TycheCashCore/BlockHeaderIndex.h"
 #include "TycheCashCore/BlockIndex.h"
 #include "TycheCashCore/Checkpoints.h"
 #include "TycheCashCore/Currency.h"
@@ -47,6 +52,7 @@ namespace TycheCash {
     // ITransactionValidator
     virtual bool checkTransactionInputs(const TycheCash::Transaction& tx, BlockInfo& maxUsedBlock) override;
     virtual bool checkTransactionInputs(const TycheCash::Transaction& tx, BlockInfo& maxUsedBlock, BlockInfo& lastFailed) override;
+    virtual void checkTransactionsInputs(const std::vector<const TycheCash::Transaction*>& transactions, std::vector<BlockInfo>& maxUsedBlocks, std::vector<bool>& valid) override;
     virtual bool haveSpentKeyImages(const TycheCash::Transaction& tx) override;
     virtual bool checkTransactionSize(size_t blobSize) override;
 
@@ -58,6 +64,16 @@ namespace TycheCash {
     std::vector<Crypto::Hash> getBlockIds(uint32_t startHeight, uint32_t maxCount);
 
     void setCheckpoints(Checkpoints&& chk_pts) { m_checkpoints = chk_pts; }
+    // Number of threads verifying ring signatures of block transactions, 0 means number of hardware threads
+    void setVerificationThreadsCount(size_t threadsCount);
+    // Calls func(i) for every i in [0, count) on the verification threads
+    void parallelFor(size_t count, const std::function<void(size_t)>& func);
+    // Computes proof of work hashes of downloaded blocks in parallel and keeps them until the blocks are pushed,
+    // so that blocks are applied without waiting for the slow hash. Can be called from any thread
+    void precomputeProofOfWork(const std::vector<const Block*>& blocks);
+    // Internal structures are stored every 'interval' blocks, so after unclean shutdown only blocks above
+    // the last stored height are replayed. 0 means the structures are stored on deinit only
+    void setCacheCheckpointInterval(uint32_t interval);
     bool getBlocks(uint32_t start_offset, uint32_t count, std::list<Block>& blocks, std::list<Transaction>& txs);
     bool getBlocks(uint32_t start_offset, uint32_t count, std::list<Block>& blocks);
     bool getAlternativeBlocks(std::list<Block>& blocks);
@@ -80,6 +96,7 @@ namespace TycheCash {
     bool resetAndSetGenesisBlock(const Block& b);
     bool haveBlock(const Crypto::Hash& id);
     size_t getTotalTransactions();
+    void getBlockCacheStatistics(uint64_t& hits, uint64_t& misses);
     std::vector<Crypto::Hash> buildSparseChain();
     std::vector<Crypto::Hash> buildSparseChain(const Crypto::Hash& startBlockId);
     uint32_t findBlockchainSupplement(const std::vector<Crypto::Hash>& qblock_ids); // !!!!
@@ -96,6 +113,7 @@ namespace TycheCash {
     bool getBlockContainingTransaction(const Crypto::Hash& txId, Crypto::Hash& blockId, uint32_t& blockHeight);
     bool getAlreadyGeneratedCoins(const Crypto::Hash& hash, uint64_t& generatedCoins);
     bool getBlockSize(const Crypto::Hash& hash, size_t& size);
+    bool getBlockHeaderInfo(uint32_t height, BlockHeaderInfo& header);
     bool getMultisigOutputReference(const MultisignatureInput& txInMultisig, std::pair<Crypto::Hash, size_t>& outputReference);
     bool getGeneratedTransactionsNumber(uint32_t height, uint64_t& generatedTransactions);
     bool getOrphanBlockIdsByHeight(uint32_t height, std::vector<Crypto::Hash>& blockHashes);
@@ -110,7 +128,7 @@ namespace TycheCash {
 
     template<class t_ids_container, class t_blocks_container, class t_missed_container>
     bool getBlocks(const t_ids_container& block_ids, t_blocks_container& blocks, t_missed_container& missed_bs) {
-      std::lock_guard<std::recursive_mutex> lk(m_blockchain_lock);
+      Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
 
       for (const auto& bl_id : block_ids) {
         uint32_t height = 0;
@@ -119,7 +137,8 @@ namespace TycheCash {
         } else {
           if (!(height < m_blocks.size())) { logger(Logging::ERROR, Logging::BRIGHT_RED) << "Internal error: bl_id=" << Common::podToHex(bl_id)
             << " have index record with offset=" << height << ", bigger then m_blocks.size()=" << m_blocks.size(); return false; }
-            blocks.push_back(m_blocks[height].bl);
+            blocks.push_back(Block());
+            m_blocks.load(height, blocks.back());
         }
       }
 
@@ -128,14 +147,14 @@ namespace TycheCash {
 
     template<class t_ids_container, class t_tx_container, class t_missed_container>
     void getBlockchainTransactions(const t_ids_container& txs_ids, t_tx_container& txs, t_missed_container& missed_txs) {
-      std::lock_guard<decltype(m_blockchain_lock)> bcLock(m_blockchain_lock);
+      Tools::SharedLockGuard<decltype(m_blockchain_lock)> bcLock(m_blockchain_lock);
 
       for (const auto& tx_id : txs_ids) {
         auto it = m_transactionMap.find(tx_id);
         if (it == m_transactionMap.end()) {
           missed_txs.push_back(tx_id);
         } else {
-          txs.push_back(transactionByIndex(it->second).tx);
+          txs.push_back(transactionByIndex(it->second)->tx);
         }
       }
     }
@@ -171,6 +190,9 @@ namespace TycheCash {
       }
     };
 
+    // Hash of a main chain transaction, its block is loaded from the block storage
+    Crypto::Hash getTransactionHash(const TransactionIndex& index);
+
   private:
 
     struct MultisignatureOutputUsage {
@@ -215,12 +237,54 @@ namespace TycheCash {
 
     typedef google::sparse_hash_set<Crypto::KeyImage> key_images_container;
     typedef std::unordered_map<Crypto::Hash, BlockEntry> blocks_ext_by_hash;
-    typedef google::sparse_hash_map<uint64_t, std::vector<std::pair<TransactionIndex, uint16_t>>> outputs_container; //Crypto::Hash - tx hash, size_t - index of out in transaction
+
+    // Key outputs of one amount in order of their global indexes, stored column by column.
+    // Keys and unlock times are kept next to output locations, so that mixin selection and input checks
+    // don't load transactions from the block storage.
+    struct KeyOutputs {
+      // transaction and index of the output in it, the transaction's block is the height column
+      std::vector<std::pair<TransactionIndex, uint16_t>> locations;
+      std::vector<Crypto::PublicKey> keys;
+      std::vector<uint64_t> unlockTimes;
+
+      size_t size() const {
+        return locations.size();
+      }
+
+      bool empty() const {
+        return locations.empty();
+      }
+
+      void push(TransactionIndex transactionIndex, uint16_t outputIndex, const Crypto::PublicKey& key, uint64_t unlockTime) {
+        locations.push_back(std::make_pair(transactionIndex, outputIndex));
+        keys.push_back(key);
+        unlockTimes.push_back(unlockTime);
+      }
+
+      void pop() {
+        locations.pop_back();
+        keys.pop_back();
+        unlockTimes.pop_back();
+      }
+
+      void serialize(ISerializer& s);
+    };
+
+    typedef google::sparse_hash_map<uint64_t, KeyOutputs> outputs_container;
     typedef google::sparse_hash_map<uint64_t, std::vector<MultisignatureOutputUsage>> MultisignatureOutputsContainer;
 
+    // Ring signature of a key input with output keys already resolved, verified apart from the rest of input checks
+    struct RingSignatureCheck {
+      Crypto::Hash prefixHash;
+      Crypto::KeyImage keyImage;
+      std::vector<Crypto::PublicKey> outputKeys;
+      std::vector<Crypto::Signature> signatures;
+    };
+
     const Currency& m_currency;
     tx_memory_pool& m_tx_pool;
-    std::recursive_mutex m_blockchain_lock; // TODO: add here reader/writer lock
+    // Read-only queries take the lock shared and may run concurrently, block application and chain switching take it exclusively
+    Tools::RecursiveSharedMutex m_blockchain_lock;
     Crypto::cn_context m_cn_context;
     Tools::ObserverManager<IBlockchainStorageObserver> m_observerManager;
 
@@ -242,6 +306,7 @@ namespace TycheCash {
 
     Blocks m_blocks;
     TycheCash::BlockIndex m_blockIndex;
+    BlockHeaderIndex m_headerIndex;
     TransactionMap m_transactionMap;
     MultisignatureOutputsContainer m_multisignatureOutputs;
 
@@ -254,7 +319,20 @@ namespace TycheCash {
 
     Logging::LoggerRef logger;
 
-    void rebuildCache();
+    std::unique_ptr<Tools::ThreadPool> m_verificationPool;
+    // Proof of work hashes are precomputed on their own threads, each one hashes with its own context
+    std::unique_ptr<Tools::ThreadPool> m_proofOfWorkPool;
+    std::vector<std::unique_ptr<Crypto::cn_context>> m_proofOfWorkContexts;
+    std::mutex m_proofOfWorkContextsLock;
+    // block hash -> proof of work
+    std::unordered_map<Crypto::Hash, Crypto::Hash> m_precomputedProofOfWork;
+    std::mutex m_precomputedProofOfWorkLock;
+    uint32_t m_cacheCheckpointInterval;
+
+    void rebuildCache(uint32_t startHeight = 0);
+    void rebuildHeaderIndex(uint32_t startHeight = 0);
+    BlockHeaderInfo makeHeaderInfo(const BlockEntry& block, const Crypto::Hash& blockHash);
+    void rebuildBlockchainIndices(uint32_t startHeight = 0);
     bool storeCache();
     bool switch_to_alternative_blockchain(std::list<blocks_ext_by_hash::iterator>& alt_chain, bool discard_disconnected_chain);
     bool handle_alternative_block(const Block& b, const Crypto::Hash& id, block_verification_context& bvc, bool sendNewAlternativeBlockMessage = true);
@@ -263,9 +341,9 @@ namespace TycheCash {
     bool validate_miner_transaction(const Block& b, uint32_t height, size_t cumulativeBlockSize, uint64_t alreadyGeneratedCoins, uint64_t fee, uint64_t& reward, int64_t& emissionChange);
     bool rollback_blockchain_switching(std::list<Block>& original_chain, size_t rollback_height);
     bool get_last_n_blocks_sizes(std::vector<size_t>& sz, size_t count);
-    bool add_out_to_get_random_outs(std::vector<std::pair<TransactionIndex, uint16_t>>& amount_outs, COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS_outs_for_amount& result_outs, uint64_t amount, size_t i);
+    bool add_out_to_get_random_outs(const KeyOutputs& amount_outs, COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS_outs_for_amount& result_outs, uint64_t amount, size_t i);
     bool is_tx_spendtime_unlocked(uint64_t unlock_time);
-    size_t find_end_of_allowed_index(const std::vector<std::pair<TransactionIndex, uint16_t>>& amount_outs);
+    size_t find_end_of_allowed_index(const KeyOutputs& amount_outs);
     bool check_block_timestamp_main(const Block& b);
     bool check_block_timestamp(std::vector<uint64_t> timestamps, const Block& b);
     uint64_t get_adjusted_time();
@@ -274,11 +352,16 @@ namespace TycheCash {
     std::vector<Crypto::Hash> doBuildSparseChain(const Crypto::Hash& startBlockId) const;
     bool getBlockCumulativeSize(const Block& block, size_t& cumulativeSize);
     bool update_next_comulative_size_limit();
-    bool check_tx_input(const KeyInput& txin, const Crypto::Hash& tx_prefix_hash, const std::vector<Crypto::Signature>& sig, uint32_t* pmax_related_block_height = NULL);
-    bool checkTransactionInputs(const Transaction& tx, const Crypto::Hash& tx_prefix_hash, uint32_t* pmax_used_block_height = NULL);
-    bool checkTransactionInputs(const Transaction& tx, uint32_t* pmax_used_block_height = NULL);
+    bool check_tx_input(const KeyInput& txin, const Crypto::Hash& tx_prefix_hash, const std::vector<Crypto::Signature>& sig, uint32_t* pmax_related_block_height = NULL, std::vector<RingSignatureCheck>* deferredChecks = NULL);
+    bool checkTransactionInputs(const Transaction& tx, const Crypto::Hash& tx_prefix_hash, uint32_t* pmax_used_block_height = NULL, std::vector<RingSignatureCheck>* deferredChecks = NULL);
+    bool checkTransactionInputs(const Transaction& tx, uint32_t* pmax_used_block_height = NULL, std::vector<RingSignatureCheck>* deferredChecks = NULL);
+    bool checkRingSignatures(const std::vector<RingSignatureCheck>& checks);
+    void checkRingSignatures(const std::vector<RingSignatureCheck>& checks, std::vector<uint8_t>& valid);
+    static bool checkRingSignatures(const std::vector<RingSignatureCheck>& checks, size_t begin, size_t end);
+    // Returns false if proof of work of the block hasn't been precomputed
+    bool takePrecomputedProofOfWork(const Crypto::Hash& blockHash, Crypto::Hash& proofOfWork);
     bool have_tx_keyimg_as_spent(const Crypto::KeyImage &key_im);
-    const TransactionEntry& transactionByIndex(TransactionIndex index);
+    std::shared_ptr<const TransactionEntry> transactionByIndex(TransactionIndex index);
     bool pushBlock(const Block& blockData, block_verification_context& bvc);
     bool pushBlock(const Block& blockData, const std::vector<Transaction>& transactions, block_verification_context& bvc);
     bool pushBlock(BlockEntry& block);
@@ -291,12 +374,16 @@ namespace TycheCash {
     bool storeBlockchainIndices();
     bool loadBlockchainIndices();
 
+    bool storeHeaderIndex();
+    void loadHeaderIndex();
+
     bool loadTransactions(const Block& block, std::vector<Transaction>& transactions);
     void saveTransactions(const std::vector<Transaction>& transactions);
 
     void sendMessage(const BlockchainMessage& message);
 
     friend class LockedBlockchainStorage;
+    friend class SharedLockedBlockchainStorage;
   };
 
   class LockedBlockchainStorage: boost::noncopyable {
@@ -312,45 +399,49 @@ namespace TycheCash {
   private:
 
     Blockchain& m_bc;
-    std::lock_guard<std::recursive_mutex> m_lock;
+    std::lock_guard<Tools::RecursiveSharedMutex> m_lock;
+  };
+
+  class SharedLockedBlockchainStorage: boost::noncopyable {
+  public:
+
+    SharedLockedBlockchainStorage(Blockchain& bc)
+      : m_bc(bc), m_lock(bc.m_blockchain_lock) {}
+
+    Blockchain* operator -> () {
+      return &m_bc;
+    }
+
+  private:
+
+    Blockchain& m_bc;
+    Tools::SharedLockGuard<Tools::RecursiveSharedMutex> m_lock;
   };
 
   template<class visitor_t> bool Blockchain::scanOutputKeysForIndexes(const KeyInput& tx_in_to_key, visitor_t& vis, uint32_t* pmax_related_block_height) {
-    std::lock_guard<std::recursive_mutex> lk(m_blockchain_lock);
+    Tools::SharedLockGuard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
     auto it = m_outputs.find(tx_in_to_key.amount);
     if (it == m_outputs.end() || !tx_in_to_key.outputIndexes.size())
       return false;
 
     std::vector<uint32_t> absolute_offsets = relative_output_offsets_to_absolute(tx_in_to_key.outputIndexes);
-    std::vector<std::pair<TransactionIndex, uint16_t>>& amount_outs_vec = it->second;
+    const KeyOutputs& amount_outs = it->second;
     size_t count = 0;
     for (uint64_t i : absolute_offsets) {
-      if(i >= amount_outs_vec.size() ) {
-        logger(Logging::INFO) << "Wrong index in transaction inputs: " << i << ", expected maximum " << amount_outs_vec.size() - 1;
-        return false;
-      }
-
-      //auto tx_it = m_transactionMap.find(amount_outs_vec[i].first);
-      //if (!(tx_it != m_transactionMap.end())) { logger(ERROR, BRIGHT_RED) << "Wrong transaction id in output indexes: " << Common::podToHex(amount_outs_vec[i].first); return false; }
-
-      const TransactionEntry& tx = transactionByIndex(amount_outs_vec[i].first);
-
-      if (!(amount_outs_vec[i].second < tx.tx.outputs.size())) {
-        logger(Logging::ERROR, Logging::BRIGHT_RED)
-            << "Wrong index in transaction outputs: "
-            << amount_outs_vec[i].second << ", expected less then "
-            << tx.tx.outputs.size();
+      if(i >= amount_outs.size() ) {
+        logger(Logging::INFO) << "Wrong index in transaction inputs: " << i << ", expected maximum " << amount_outs.size() - 1;
         return false;
       }
 
-      if (!vis.handle_output(tx.tx, tx.tx.outputs[amount_outs_vec[i].second], amount_outs_vec[i].second)) {
+      const std::pair<TransactionIndex, uint16_t>& location = amount_outs.locations[i];
+      if (!vis.handle_output(location.first, location.second, amount_outs.keys[i], amount_outs.unlockTimes[i])) {
         logger(Logging::INFO) << "Failed to handle_output for output no = " << count << ", with absolute offset " << i;
         return false;
       }
 
       if(count++ == absolute_offsets.size()-1 && pmax_related_block_height) {
-        if (*pmax_related_block_height < amount_outs_vec[i].first.block) {
-          *pmax_related_block_height = amount_outs_vec[i].first.block;
+        if (*pmax_related_block_height < location.first.block) {
+          *pmax_related_block_height = location.first.block;
         }
       }
     }
@@ -119,6 +119,8 @@ size_t core::get_alternative_blocks_count() {
     bool r = m_mempool.init(m_config_folder);
   if (!(r)) { logger(ERROR, BRIGHT_RED) << "Failed to initialize memory pool"; return false; }
 
+  m_blockchain.setVerificationThreadsCount(config.verificationThreads);
+  m_blockchain.setCacheCheckpointInterval(config.cacheCheckpointInterval);
   r = m_blockchain.init(m_config_folder, load_existing);
   if (!(r)) { logger(ERROR, BRIGHT_RED) << "Failed to initialize blockchain storage"; return false; }
 
@@ -277,6 +279,10 @@ size_t core::get_blockchain_total_transactions() {
   return m_blockchain.getTotalTransactions();
 }
 
+void core::get_block_cache_statistics(uint64_t& hits, uint64_t& misses) {
+  m_blockchain.getBlockCacheStatistics(hits, misses);
+}
+
 //bool core::get_outs(uint64_t amount, std::list<Crypto::PublicKey>& pkeys)
 //{
 //  return m_blockchain.get_outs(amount, pkeys);
@@ -539,6 +545,10 @@ bool core::have_block(const Crypto::Hash& id) {
   return m_blockchain.haveBlock(id);
 }
 
+bool core::haveTransaction(const Crypto::Hash& id) {
+  return m_mempool.have_tx(id) || m_blockchain.haveTransaction(id);
+}
+
 bool core::parse_tx_from_blob(Transaction& tx, Crypto::Hash& tx_hash, Crypto::Hash& tx_prefix_hash, const BinaryArray& blob) {
   return parseAndValidateTransactionFromBinaryArray(blob, tx, tx_hash, tx_prefix_hash);
 }
@@ -564,7 +574,7 @@ std::vector<Crypto::Hash> core::buildSparseChain() {
 }
 
 std::vector<Crypto::Hash> core::buildSparseChain(const Crypto::Hash& startBlockId) {
-  LockedBlockchainStorage lbs(m_blockchain);
+  SharedLockedBlockchainStorage lbs(m_blockchain);
   assert(m_blockchain.haveBlock(startBlockId));
   return m_blockchain.buildSparseChain(startBlockId);
 }
@@ -574,7 +584,7 @@ bool core::handle_get_objects(NOTIFY_REQUEST_GET_OBJECTS::request& arg, NOTIFY_R
 }
 
 Crypto::Hash core::getBlockIdByHeight(uint32_t height) {
-  LockedBlockchainStorage lbs(m_blockchain);
+  SharedLockedBlockchainStorage lbs(m_blockchain);
   if (height < m_blockchain.getCurrentBlockchainHeight()) {
     return m_blockchain.getBlockIdByHeight(height);
   } else {
@@ -645,7 +655,7 @@ void core::poolUpdated() {
 bool core::queryBlocks(const std::vector<Crypto::Hash>& knownBlockIds, uint64_t timestamp,
   uint32_t& resStartHeight, uint32_t& resCurrentHeight, uint32_t& resFullOffset, std::vector<BlockFullInfo>& entries) {
 
-  LockedBlockchainStorage lbs(m_blockchain);
+  SharedLockedBlockchainStorage lbs(m_blockchain);
 
   uint32_t currentHeight = lbs->getCurrentBlockchainHeight();
   uint32_t startOffset = 0;
@@ -702,7 +712,7 @@ bool core::queryBlocks(const std::vector<Crypto::Hash>& knownBlockIds, uint64_t
 }
 
 bool core::findStartAndFullOffsets(const std::vector<Crypto::Hash>& knownBlockIds, uint64_t timestamp, uint32_t& startOffset, uint32_t& startFullOffset) {
-  LockedBlockchainStorage lbs(m_blockchain);
+  SharedLockedBlockchainStorage lbs(m_blockchain);
 
   if (knownBlockIds.empty()) {
     logger(ERROR, BRIGHT_RED) << "knownBlockIds is empty";
@@ -725,7 +735,7 @@ bool core::findStartAndFullOffsets(const std::vector<Crypto::Hash>& knownBlockId
 std::vector<Crypto::Hash> core::findIdsForShortBlocks(uint32_t startOffset, uint32_t startFullOffset) {
   assert(startOffset <= startFullOffset);
 
-  LockedBlockchainStorage lbs(m_blockchain);
+  SharedLockedBlockchainStorage lbs(m_blockchain);
 
   std::vector<Crypto::Hash> result;
   if (startOffset < startFullOffset) {
@@ -737,7 +747,7 @@ std::vector<Crypto::Hash> core::findIdsForShortBlocks(uint32_t startOffset, uint
 
 bool core::queryBlocksLite(const std::vector<Crypto::Hash>& knownBlockIds, uint64_t timestamp, uint32_t& resStartHeight,
   uint32_t& resCurrentHeight, uint32_t& resFullOffset, std::vector<BlockShortInfo>& entries) {
-  LockedBlockchainStorage lbs(m_blockchain);
+  SharedLockedBlockchainStorage lbs(m_blockchain);
 
   resCurrentHeight = lbs->getCurrentBlockchainHeight();
   resStartHeight = 0;
@@ -803,6 +813,10 @@ bool core::getAlreadyGeneratedCoins(const Crypto::Hash& hash, uint64_t& generate
   return m_blockchain.getAlreadyGeneratedCoins(hash, generatedCoins);
 }
 
+bool core::getBlockHeaderInfo(uint32_t height, BlockHeaderInfo& header) {
+  return m_blockchain.getBlockHeaderInfo(height, header);
+}
+
 bool core::getBlockReward(size_t medianSize, size_t currentBlockSize, uint64_t alreadyGeneratedCoins, uint64_t fee,
                           uint64_t& reward, int64_t& emissionChange) {
   return m_currency.getBlockReward(medianSize, currentBlockSize, alreadyGeneratedCoins, fee, reward, emissionChange);
@@ -812,15 +826,16 @@ bool core::scanOutputkeysForIndices(const KeyInput& txInToKey, std::list<std::pa
   struct outputs_visitor
   {
     std::list<std::pair<Crypto::Hash, size_t>>& m_resultsCollector;
-    outputs_visitor(std::list<std::pair<Crypto::Hash, size_t>>& resultsCollector):m_resultsCollector(resultsCollector){}
-    bool handle_output(const Transaction& tx, const TransactionOutput& out, size_t transactionOutputIndex)
+    Blockchain& m_blockchain;
+    outputs_visitor(std::list<std::pair<Crypto::Hash, size_t>>& resultsCollector, Blockchain& blockchain):m_resultsCollector(resultsCollector), m_blockchain(blockchain){}
+    bool handle_output(const Blockchain::TransactionIndex& transactionIndex, uint16_t transactionOutputIndex, const Crypto::PublicKey& key, uint64_t unlockTime)
     {
-      m_resultsCollector.push_back(std::make_pair(getObjectHash(tx), transactionOutputIndex));
+      m_resultsCollector.push_back(std::make_pair(m_blockchain.getTransactionHash(transactionIndex), transactionOutputIndex));
       return true;
     }
   };
     
-  outputs_visitor vi(outputReferences);
+  outputs_visitor vi(outputReferences, m_blockchain);
     
   return m_blockchain.scanOutputKeysForIndexes(txInToKey, vi);
 }
@@ -940,6 +955,103 @@ bool core::handleIncomingTransaction(const Transaction& tx, const Crypto::Hash&
   }
 
   bool r = add_new_tx(tx, txHash, blobSize, tvc, keptByBlock);
+  logTransactionVerification(txHash, tvc);
+  if (tvc.m_added_to_pool) {
+    poolUpdated();
+  }
+
+  return r;
+}
+
+void core::precomputeProofOfWork(const std::vector<const Block*>& blocks) {
+  m_blockchain.precomputeProofOfWork(blocks);
+}
+
+void core::handleIncomingTransactions(const std::vector<BinaryArray>& transactionBlobs, std::vector<tx_verification_context>& tvcs, bool keptByBlock) {
+  enum CheckResult : uint8_t { CHECK_OK, CHECK_TOO_BIG, CHECK_PARSE_FAILED, CHECK_SYNTAX_FAILED, CHECK_SEMANTIC_FAILED };
+
+  tvcs.assign(transactionBlobs.size(), boost::value_initialized<tx_verification_context>());
+
+  // checks which don't need the blockchain are done in parallel
+  std::vector<Transaction> transactions(transactionBlobs.size());
+  std::vector<Crypto::Hash> hashes(transactionBlobs.size(), NULL_HASH);
+  std::vector<uint8_t> results(transactionBlobs.size(), CHECK_OK);
+  m_blockchain.parallelFor(transactionBlobs.size(), [&](size_t i) {
+    Crypto::Hash prefixHash;
+    if (transactionBlobs[i].size() > m_currency.maxTxSize()) {
+      results[i] = CHECK_TOO_BIG;
+    } else if (!parse_tx_from_blob(transactions[i], hashes[i], prefixHash, transactionBlobs[i])) {
+      results[i] = CHECK_PARSE_FAILED;
+    } else if (!check_tx_syntax(transactions[i])) {
+      results[i] = CHECK_SYNTAX_FAILED;
+    } else if (!check_tx_semantic(transactions[i], keptByBlock)) {
+      results[i] = CHECK_SEMANTIC_FAILED;
+    }
+  });
+
+  std::vector<Transaction> poolTransactions;
+  std::vector<Crypto::Hash> poolHashes;
+  std::vector<size_t> poolBlobSizes;
+  std::vector<size_t> poolIndexes;
+  std::vector<tx_verification_context> poolTvcs;
+  {
+    //Locking on m_mempool and m_blockchain closes possibility to add tx to memory pool which is already in blockchain
+    std::lock_guard<decltype(m_mempool)> lk(m_mempool);
+    LockedBlockchainStorage lbs(m_blockchain);
+
+    std::unordered_set<Crypto::Hash> batchHashes;
+    for (size_t i = 0; i < transactionBlobs.size(); ++i) {
+      switch (results[i]) {
+      case CHECK_TOO_BIG:
+        logger(INFO) << "WRONG TRANSACTION BLOB, too big size " << transactionBlobs[i].size() << ", rejected";
+        tvcs[i].m_verification_failed = true;
+        continue;
+      case CHECK_PARSE_FAILED:
+        logger(INFO) << "WRONG TRANSACTION BLOB, Failed to parse, rejected";
+        tvcs[i].m_verification_failed = true;
+        continue;
+      case CHECK_SYNTAX_FAILED:
+        logger(INFO) << "WRONG TRANSACTION BLOB, Failed to check tx " << hashes[i] << " syntax, rejected";
+        tvcs[i].m_verification_failed = true;
+        continue;
+      case CHECK_SEMANTIC_FAILED:
+        logger(INFO) << "WRONG TRANSACTION BLOB, Failed to check tx " << hashes[i] << " semantic, rejected";
+        tvcs[i].m_verification_failed = true;
+        continue;
+      }
+
+      if (m_blockchain.haveTransaction(hashes[i])) {
+        logger(TRACE) << "tx " << hashes[i] << " is already in blockchain";
+        continue;
+      }
+
+      if (m_mempool.have_tx(hashes[i]) || !batchHashes.insert(hashes[i]).second) {
+        logger(TRACE) << "tx " << hashes[i] << " is already in transaction pool";
+        continue;
+      }
+
+      poolTransactions.push_back(std::move(transactions[i]));
+      poolHashes.push_back(hashes[i]);
+      poolBlobSizes.push_back(transactionBlobs[i].size());
+      poolIndexes.push_back(i);
+    }
+
+    m_mempool.add_txs(poolTransactions, poolHashes, poolBlobSizes, poolTvcs, keptByBlock);
+  }
+
+  bool poolChanged = false;
+  for (size_t j = 0; j < poolIndexes.size(); ++j) {
+    tvcs[poolIndexes[j]] = poolTvcs[j];
+    logTransactionVerification(poolHashes[j], poolTvcs[j]);
+    poolChanged = poolChanged || poolTvcs[j].m_added_to_pool;
+  }
+
+  if (poolChanged) {
+    poolUpdated();
+  }
+}
+
+void core::logTransactionVerification(const Crypto::Hash& txHash, const tx_verification_context& tvc) {
   if (tvc.m_verification_failed) {
     if (!tvc.m_tx_fee_too_small) {
       logger(ERROR) << "Transaction verification failed: " << txHash;
@@ -952,10 +1064,7 @@ bool core::handleIncomingTransaction(const Transaction& tx, const Crypto::Hash&
 
   if (tvc.m_added_to_pool) {
     logger(DEBUGGING) << "tx added: " << txHash;
-    poolUpdated();
   }
-
-  return r;
 }
 
 std::unique_ptr<IBlock> core::getBlock(const Crypto::Hash& blockId) {
@@ -9,8 +9,15 @@
 
 namespace TycheCash {
 
+namespace {
+const command_line::arg_descriptor<uint32_t> arg_verification_threads = {"verification-threads", "Specify number of threads verifying ring signatures of blocks, 0 means number of hardware threads", 0, true};
+const command_line::arg_descriptor<uint32_t> arg_cache_checkpoint_interval = {"cache-checkpoint-interval", "Store blockchain cache every N blocks to speed up start after unclean shutdown, 0 means store on exit only", 1000, true};
+}
+
 CoreConfig::CoreConfig() {
   configFolder = Tools::getDefaultDataDirectory();
+  verificationThreads = 0;
+  cacheCheckpointInterval = 1000;
 }
 
 void CoreConfig::init(const boost::program_options::variables_map& options) {
@@ -18,8 +25,18 @@ void CoreConfig::init(const boost::program_options::variables_map& options) {
     configFolder = command_line::get_arg(options, command_line::arg_data_dir);
     configFolderDefaulted = options[command_line::arg_data_dir.name].defaulted();
   }
+
+  if (command_line::has_arg(options, arg_verification_threads) && !options[arg_verification_threads.name].defaulted()) {
+    verificationThreads = command_line::get_arg(options, arg_verification_threads);
+  }
+
+  if (command_line::has_arg(options, arg_cache_checkpoint_interval) && !options[arg_cache_checkpoint_interval.name].defaulted()) {
+    cacheCheckpointInterval = command_line::get_arg(options, arg_cache_checkpoint_interval);
+  }
 }
 
 void CoreConfig::initOptions(boost::program_options::options_description& desc) {
+  command_line::add_arg(desc, arg_verification_threads);
+  command_line::add_arg(desc, arg_cache_checkpoint_interval);
 }
 } //namespace TycheCash
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 #include <boost/program_options.hpp>
@@ -19,6 +20,8 @@ public:
 
   std::string configFolder;
   bool configFolderDefaulted = true;
+  uint32_t verificationThreads;
+  uint32_t cacheCheckpointInterval;
 };
 
 } //namespace TycheCash
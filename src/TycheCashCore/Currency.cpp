@@ -63,6 +63,7 @@ bool Currency::init() {
     m_blockIndexesFileName = "testnet_" + m_blockIndexesFileName;
     m_txPoolFileName = "testnet_" + m_txPoolFileName;
     m_blockchinIndicesFileName = "testnet_" + m_blockchinIndicesFileName;
+    m_blockHeadersFileName = "testnet_" + m_blockHeadersFileName;
   }
 
   return true;
@@ -638,6 +639,7 @@ CurrencyBuilder::CurrencyBuilder(Logging::ILogger& log) : m_currency(log) {
   blockIndexesFileName(parameters::TycheCash_BLOCKINDEXES_FILENAME);
   txPoolFileName(parameters::TycheCash_POOLDATA_FILENAME);
   blockchinIndicesFileName(parameters::TycheCash_BLOCKCHAIN_INDICES_FILENAME);
+  blockHeadersFileName(parameters::TycheCash_BLOCKHEADERS_FILENAME);
 
   testnet(false);
 }
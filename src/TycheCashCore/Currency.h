@@ -69,6 +69,7 @@ public:
   const std::string& blockIndexesFileName() const { return m_blockIndexesFileName; }
   const std::string& txPoolFileName() const { return m_txPoolFileName; }
   const std::string& blockchinIndicesFileName() const { return m_blockchinIndicesFileName; }
+  const std::string& blockHeadersFileName() const { return m_blockHeadersFileName; }
 
   bool isTestnet() const { return m_testnet; }
 
@@ -164,6 +165,7 @@ private:
   std::string m_blockIndexesFileName;
   std::string m_txPoolFileName;
   std::string m_blockchinIndicesFileName;
+  std::string m_blockHeadersFileName;
 
   static const std::vector<uint64_t> PRETTY_AMOUNTS;
 
@@ -236,6 +238,7 @@ public:
   CurrencyBuilder& blockIndexesFileName(const std::string& val) { m_currency.m_blockIndexesFileName = val; return *this; }
   CurrencyBuilder& txPoolFileName(const std::string& val) { m_currency.m_txPoolFileName = val; return *this; }
   CurrencyBuilder& blockchinIndicesFileName(const std::string& val) { m_currency.m_blockchinIndicesFileName = val; return *this; }
+  CurrencyBuilder& blockHeadersFileName(const std::string& val) { m_currency.m_blockHeadersFileName = val; return *this; }
 
   CurrencyBuilder& testnet(bool val) { m_currency.m_testnet = val; return *this; }
 
@@ -29,6 +29,7 @@ class ICoreObserver;
 struct Block;
 struct block_verification_context;
 struct BlockFullInfo;
+struct BlockHeaderInfo;
 struct BlockShortInfo;
 struct core_stat_info;
 struct i_TycheCash_protocol;
@@ -46,6 +47,8 @@ public:
   virtual bool removeObserver(ICoreObserver* observer) = 0;
 
   virtual bool have_block(const Crypto::Hash& id) = 0;
+  // Looks for the transaction both in the blockchain and in the pool
+  virtual bool haveTransaction(const Crypto::Hash& id) = 0;
   virtual std::vector<Crypto::Hash> buildSparseChain() = 0;
   virtual std::vector<Crypto::Hash> buildSparseChain(const Crypto::Hash& startBlockId) = 0;
   virtual bool get_stat_info(TycheCash::core_stat_info& st_inf) = 0;
@@ -53,6 +56,7 @@ public:
   virtual void pause_mining() = 0;
   virtual void update_block_template_and_resume_mining() = 0;
   virtual bool handle_incoming_block_blob(const TycheCash::BinaryArray& block_blob, TycheCash::block_verification_context& bvc, bool control_miner, bool relay_block) = 0;
+  virtual bool handle_incoming_block(const Block& b, block_verification_context& bvc, bool control_miner, bool relay_block) = 0;
   virtual bool handle_get_objects(NOTIFY_REQUEST_GET_OBJECTS_request& arg, NOTIFY_RESPONSE_GET_OBJECTS_request& rsp) = 0; //Deprecated. Should be removed with TycheCashProtocolHandler.
   virtual void on_synchronized() = 0;
   virtual size_t addChain(const std::vector<const IBlock*>& chain) = 0;
@@ -84,6 +88,7 @@ public:
   virtual bool getBackwardBlocksSizes(uint32_t fromHeight, std::vector<size_t>& sizes, size_t count) = 0;
   virtual bool getBlockSize(const Crypto::Hash& hash, size_t& size) = 0;
   virtual bool getAlreadyGeneratedCoins(const Crypto::Hash& hash, uint64_t& generatedCoins) = 0;
+  virtual bool getBlockHeaderInfo(uint32_t height, BlockHeaderInfo& header) = 0;
   virtual bool getBlockReward(size_t medianSize, size_t currentBlockSize, uint64_t alreadyGeneratedCoins, uint64_t fee,
                               uint64_t& reward, int64_t& emissionChange) = 0;
   virtual bool scanOutputkeysForIndices(const KeyInput& txInToKey, std::list<std::pair<Crypto::Hash, size_t>>& outputReferences) = 0;
@@ -99,6 +104,10 @@ public:
 
   virtual std::unique_ptr<IBlock> getBlock(const Crypto::Hash& blocksId) = 0;
   virtual bool handleIncomingTransaction(const Transaction& tx, const Crypto::Hash& txHash, size_t blobSize, tx_verification_context& tvc, bool keptByBlock) = 0;
+  // Parses and verifies transactions in parallel and adds them to the pool at once, tvcs[i] is the result for transactionBlobs[i]
+  virtual void handleIncomingTransactions(const std::vector<BinaryArray>& transactionBlobs, std::vector<tx_verification_context>& tvcs, bool keptByBlock) = 0;
+  // Computes proof of work of downloaded blocks in parallel ahead of their handling, the result is used once they are pushed
+  virtual void precomputeProofOfWork(const std::vector<const Block*>& blocks) = 0;
   virtual std::error_code executeLocked(const std::function<std::error_code()>& func) = 0;
 
   virtual bool addMessageQueue(MessageQueue<BlockchainMessage>& messageQueue) = 0;
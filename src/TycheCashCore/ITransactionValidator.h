@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "TycheCashCore/TycheCashBasic.h"
 
 namespace TycheCash {
@@ -32,6 +34,8 @@ namespace TycheCash {
     
     virtual bool checkTransactionInputs(const TycheCash::Transaction& tx, BlockInfo& maxUsedBlock) = 0;
     virtual bool checkTransactionInputs(const TycheCash::Transaction& tx, BlockInfo& maxUsedBlock, BlockInfo& lastFailed) = 0;
+    // Checks inputs of several transactions at once, valid[i] is the result for transactions[i]
+    virtual void checkTransactionsInputs(const std::vector<const TycheCash::Transaction*>& transactions, std::vector<BlockInfo>& maxUsedBlocks, std::vector<bool>& valid) = 0;
     virtual bool haveSpentKeyImages(const TycheCash::Transaction& tx) = 0;
     virtual bool checkTransactionSize(size_t blobSize) = 0;
   };
@@ -337,12 +337,23 @@ namespace TycheCash
   //-----------------------------------------------------------------------------------------------------
   bool miner::worker_thread(uint32_t th_local_index)
   {
-    logger(INFO) << "Miner thread was started ["<< th_local_index << "]";
     uint32_t nonce = m_starter_nonce + th_local_index;
     difficulty_type local_diff = 0;
     uint32_t local_template_ver = 0;
-    Crypto::cn_context context;
-    Block b;
+    // several nonces are hashed at once, every one of them with its own context
+    const size_t ways = Crypto::cn_slow_hash_preferred_ways();
+    std::vector<std::unique_ptr<Crypto::cn_context>> contexts;
+    std::vector<Crypto::cn_context*> contextPointers;
+    for (size_t i = 0; i < ways; ++i) {
+      contexts.emplace_back(new Crypto::cn_context());
+      contextPointers.push_back(contexts.back().get());
+    }
+
+    logger(INFO) << "Miner thread was started ["<< th_local_index << "], scratchpads use " <<
+      Crypto::cn_context::pageModeName(contexts.front()->pageMode());
+
+    std::vector<Block> blocks(ways);
+    std::vector<Crypto::Hash> hashes(ways);
 
     while(!m_stop)
     {
@@ -354,7 +365,7 @@ namespace TycheCash
 
       if(local_template_ver != m_template_no) {
         std::unique_lock<std::mutex> lk(m_template_lock);
-        b = m_template;
+        blocks.assign(ways, m_template);
         local_diff = m_diffic;
         lk.unlock();
 
@@ -369,30 +380,36 @@ namespace TycheCash
         continue;
       }
 
-      b.nonce = nonce;
-      Crypto::Hash h;
-      if (!m_stop && !get_block_longhash(context, b, h)) {
+      for (size_t i = 0; i < ways; ++i) {
+        blocks[i].nonce = nonce + static_cast<uint32_t>(i) * m_threads_total;
+      }
+
+      if (!m_stop && !get_block_longhashes(contextPointers.data(), blocks.data(), ways, hashes.data())) {
         logger(ERROR) << "Failed to get block long hash";
         m_stop = true;
       }
 
-      if (!m_stop && check_hash(h, local_diff))
-      {
-        //we lucky!
-        ++m_config.current_extra_message_index;
+      for (size_t i = 0; i < ways && !m_stop; ++i) {
+        if (check_hash(hashes[i], local_diff))
+        {
+          //we lucky!
+          ++m_config.current_extra_message_index;
 
-        logger(INFO, GREEN) << "Found block for difficulty: " << local_diff;
+          logger(INFO, GREEN) << "Found block for difficulty: " << local_diff;
+
+          if(!m_handler.handle_block_found(blocks[i])) {
+            --m_config.current_extra_message_index;
+          } else {
+            //success update, lets update config
+            Common::saveStringToFile(m_config_folder_path + "/" + TycheCash::parameters::MINER_CONFIG_FILE_NAME, storeToJson(m_config));
+          }
 
-        if(!m_handler.handle_block_found(b)) {
-          --m_config.current_extra_message_index;
-        } else {
-          //success update, lets update config
-          Common::saveStringToFile(m_config_folder_path + "/" + TycheCash::parameters::MINER_CONFIG_FILE_NAME, storeToJson(m_config));
+          break;
         }
       }
 
-      nonce += m_threads_total;
-      ++m_hashes;
+      nonce += static_cast<uint32_t>(ways) * m_threads_total;
+      m_hashes += ways;
     }
     logger(INFO) << "Miner thread stopped ["<< th_local_index << "]";
     return true;
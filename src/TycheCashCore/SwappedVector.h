@@ -11,9 +11,15 @@
 #include <iostream>
 #include <list>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "Common/MemoryInputStream.h"
 #include "Common/StdInputStream.h"
 #include "Common/StdOutputStream.h"
 #include "Serialization/BinaryInputStreamSerializer.h"
@@ -138,24 +144,33 @@ public:
   bool open(const std::string& itemFileName, const std::string& indexFileName, size_t poolSize);
   void close();
 
+  // Reading methods (operator[], get, load, front, back, statistics) may be called concurrently with each other,
+  // modifying methods (open, clear, pop_back, push_back) require exclusive access.
   bool empty() const;
   uint64_t size() const;
   const_iterator begin();
   const_iterator end();
   const T& operator[](uint64_t index);
+  // Returned item stays alive while referenced, even if it is evicted from the cache by another reader.
+  std::shared_ptr<const T> get(uint64_t index);
+  // Decodes leading fields of item into 'item', which serializes as prefix of 'T'. Cache is neither used nor updated.
+  template<class U> void load(uint64_t index, U& item);
   const T& front();
   const T& back();
   void clear();
   void pop_back();
   void push_back(const T& item);
 
+  uint64_t cacheHits();
+  uint64_t cacheMisses();
+
 private:
   struct ItemEntry;
   struct CacheEntry;
 
   struct ItemEntry {
   public:
-    T item;
+    std::shared_ptr<T> item;
     typename std::list<CacheEntry>::iterator cacheIter;
   };
 
@@ -164,8 +179,14 @@ private:
     typename std::map<uint64_t, ItemEntry>::iterator itemIter;
   };
 
+  std::mutex m_mutex;
   std::fstream m_itemsFile;
   std::fstream m_indexesFile;
+  std::string m_itemsFileName;
+  boost::interprocess::file_mapping m_itemsMapping;
+  std::shared_ptr<boost::interprocess::mapped_region> m_itemsRegion;
+  uint64_t m_mappedSize;
+  bool m_mappingFailed;
   size_t m_poolSize;
   std::vector<uint64_t> m_offsets;
   uint64_t m_itemsFileSize;
@@ -174,10 +195,12 @@ private:
   uint64_t m_cacheHits;
   uint64_t m_cacheMisses;
 
-  T* prepare(uint64_t index);
+  std::shared_ptr<T>& prepare(uint64_t index);
+  bool map(uint64_t size);
+  uint64_t itemSize(uint64_t index) const;
 };
 
-template<class T> SwappedVector<T>::SwappedVector() {
+template<class T> SwappedVector<T>::SwappedVector() : m_mappedSize(0), m_mappingFailed(false), m_cacheHits(0), m_cacheMisses(0) {
 }
 
 template<class T> SwappedVector<T>::~SwappedVector() {
@@ -230,6 +253,11 @@ template<class T> bool SwappedVector<T>::open(const std::string& itemFileName, c
     m_itemsFileSize = 0;
   }
 
+  m_itemsFileName = itemFileName;
+  m_itemsRegion.reset();
+  m_itemsMapping = boost::interprocess::file_mapping();
+  m_mappedSize = 0;
+  m_mappingFailed = false;
   m_poolSize = poolSize;
   m_items.clear();
   m_cache.clear();
@@ -259,35 +287,76 @@ template<class T> typename SwappedVector<T>::const_iterator SwappedVector<T>::en
 }
 
 template<class T> const T& SwappedVector<T>::operator[](uint64_t index) {
-  auto itemIter = m_items.find(index);
-  if (itemIter != m_items.end()) {
-    if (itemIter->second.cacheIter != --m_cache.end()) {
-      m_cache.splice(m_cache.end(), m_cache, itemIter->second.cacheIter);
+  return *get(index);
+}
+
+template<class T> std::shared_ptr<const T> SwappedVector<T>::get(uint64_t index) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto itemIter = m_items.find(index);
+    if (itemIter != m_items.end()) {
+      if (itemIter->second.cacheIter != --m_cache.end()) {
+        m_cache.splice(m_cache.end(), m_cache, itemIter->second.cacheIter);
+      }
+
+      ++m_cacheHits;
+      return itemIter->second.item;
     }
 
-    ++m_cacheHits;
-    return itemIter->second.item;
+    if (index >= m_offsets.size()) {
+      throw std::runtime_error("SwappedVector::get");
+    }
+
+    ++m_cacheMisses;
   }
 
-  if (index >= m_offsets.size()) {
-    throw std::runtime_error("SwappedVector::operator[]");
+  // Decode without holding the mutex, so that misses of concurrent readers do not serialize
+  std::shared_ptr<T> item = std::make_shared<T>();
+  load(index, *item);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto itemIter = m_items.find(index);
+  if (itemIter != m_items.end()) {
+    return itemIter->second.item;
   }
 
-  if (!m_itemsFile) {
-    throw std::runtime_error("SwappedVector::operator[]");
+  prepare(index) = item;
+  return item;
+}
+
+template<class T> template<class U> void SwappedVector<T>::load(uint64_t index, U& item) {
+  std::shared_ptr<boost::interprocess::mapped_region> region;
+  uint64_t offset;
+  uint64_t size;
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (index >= m_offsets.size()) {
+      throw std::runtime_error("SwappedVector::load");
+    }
+
+    offset = m_offsets[index];
+    size = itemSize(index);
+    if (offset + size <= m_mappedSize || map(m_itemsFileSize)) {
+      // Region is kept alive by this reader even if it is replaced by a larger one meanwhile
+      region = m_itemsRegion;
+    } else {
+      // Mapping is not available, fall back to reading from the stream
+      if (!m_itemsFile) {
+        throw std::runtime_error("SwappedVector::load");
+      }
+
+      m_itemsFile.seekg(offset);
+      Common::StdInputStream stream(m_itemsFile);
+      TycheCash::BinaryInputStreamSerializer archive(stream);
+      serialize(item, archive);
+      return;
+    }
   }
 
-  m_itemsFile.seekg(m_offsets[index]);
-  T tempItem;
-  
-  Common::StdInputStream stream(m_itemsFile);
+  Common::MemoryInputStream stream(static_cast<const uint8_t*>(region->get_address()) + offset, static_cast<size_t>(size));
   TycheCash::BinaryInputStreamSerializer archive(stream);
-  serialize(tempItem, archive);
-
-  T* item = prepare(index);
-  std::swap(tempItem, *item);
-  ++m_cacheMisses;
-  return *item;
+  serialize(item, archive);
 }
 
 template<class T> const T& SwappedVector<T>::front() {
@@ -310,6 +379,7 @@ template<class T> void SwappedVector<T>::clear() {
     throw std::runtime_error("SwappedVector::clear");
   }
 
+  std::lock_guard<std::mutex> lock(m_mutex);
   m_offsets.clear();
   m_itemsFileSize = 0;
   m_items.clear();
@@ -328,6 +398,7 @@ template<class T> void SwappedVector<T>::pop_back() {
     throw std::runtime_error("SwappedVector::pop_back");
   }
 
+  std::lock_guard<std::mutex> lock(m_mutex);
   m_itemsFileSize = m_offsets.back();
   m_offsets.pop_back();
   auto itemIter = m_items.find(m_offsets.size());
@@ -352,6 +423,12 @@ template<class T> void SwappedVector<T>::push_back(const T& item) {
     serialize(const_cast<T&>(item), archive);
 
     itemsFileSize = m_itemsFile.tellp();
+
+    // Make written item visible through the mapping
+    m_itemsFile.flush();
+    if (!m_itemsFile) {
+      throw std::runtime_error("SwappedVector::push_back");
+    }
   }
 
   {
@@ -374,14 +451,14 @@ template<class T> void SwappedVector<T>::push_back(const T& item) {
     }
   }
 
+  std::lock_guard<std::mutex> lock(m_mutex);
   m_offsets.push_back(m_itemsFileSize);
   m_itemsFileSize = itemsFileSize;
 
-  T* newItem = prepare(m_offsets.size() - 1);
-  *newItem = item;
+  prepare(m_offsets.size() - 1) = std::make_shared<T>(item);
 }
 
-template<class T> T* SwappedVector<T>::prepare(uint64_t index) {
+template<class T> std::shared_ptr<T>& SwappedVector<T>::prepare(uint64_t index) {
   if (m_items.size() == m_poolSize) {
     auto cacheIter = m_cache.begin();
     m_items.erase(cacheIter->itemIter);
@@ -392,5 +469,42 @@ template<class T> T* SwappedVector<T>::prepare(uint64_t index) {
   CacheEntry cacheEntry = { itemIter.first };
   auto cacheIter = m_cache.insert(m_cache.end(), cacheEntry);
   itemIter.first->second.cacheIter = cacheIter;
-  return &itemIter.first->second.item;
+  return itemIter.first->second.item;
+}
+
+template<class T> uint64_t SwappedVector<T>::cacheHits() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_cacheHits;
+}
+
+template<class T> uint64_t SwappedVector<T>::cacheMisses() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_cacheMisses;
+}
+
+template<class T> bool SwappedVector<T>::map(uint64_t size) {
+  if (m_mappingFailed || size == 0) {
+    return false;
+  }
+
+  try {
+    if (!m_itemsRegion) {
+      boost::interprocess::file_mapping(m_itemsFileName.c_str(), boost::interprocess::read_only).swap(m_itemsMapping);
+    }
+
+    m_itemsRegion = std::make_shared<boost::interprocess::mapped_region>(m_itemsMapping, boost::interprocess::read_only, 0, static_cast<size_t>(size));
+    m_mappedSize = size;
+  } catch (std::exception& e) {
+    std::cout << "SwappedVector: failed to map items file, falling back to stream reads: " << e.what() << std::endl;
+    m_itemsRegion.reset();
+    m_mappedSize = 0;
+    m_mappingFailed = true;
+    return false;
+  }
+
+  return true;
+}
+
+template<class T> uint64_t SwappedVector<T>::itemSize(uint64_t index) const {
+  return (index + 1 < m_offsets.size() ? m_offsets[index + 1] : m_itemsFileSize) - m_offsets[index];
 }
@@ -99,6 +99,53 @@ namespace TycheCash {
   }
   //---------------------------------------------------------------------------------
   bool tx_memory_pool::add_tx(const Transaction &tx, /*const Crypto::Hash& tx_prefix_hash,*/ const Crypto::Hash &id, size_t blobSize, tx_verification_context& tvc, bool keptByBlock) {
+    uint64_t fee;
+    bool isFusionTransaction;
+    if (!checkTransaction(tx, id, blobSize, tvc, keptByBlock, fee, isFusionTransaction)) {
+      return false;
+    }
+
+    BlockInfo maxUsedBlock;
+
+    // check inputs
+    bool inputsValid = m_validator.checkTransactionInputs(tx, maxUsedBlock);
+
+    return insertTransaction(tx, id, blobSize, tvc, keptByBlock, fee, isFusionTransaction, inputsValid, maxUsedBlock);
+  }
+  //---------------------------------------------------------------------------------
+  void tx_memory_pool::add_txs(const std::vector<Transaction>& txs, const std::vector<Crypto::Hash>& ids, const std::vector<size_t>& blobSizes, std::vector<tx_verification_context>& tvcs, bool keptByBlock) {
+    assert(txs.size() == ids.size() && txs.size() == blobSizes.size());
+    tvcs.assign(txs.size(), boost::value_initialized<tx_verification_context>());
+
+    std::vector<size_t> checked;
+    std::vector<uint64_t> fees(txs.size());
+    std::vector<uint8_t> fusion(txs.size());
+    for (size_t i = 0; i < txs.size(); ++i) {
+      bool isFusionTransaction;
+      if (checkTransaction(txs[i], ids[i], blobSizes[i], tvcs[i], keptByBlock, fees[i], isFusionTransaction)) {
+        fusion[i] = isFusionTransaction;
+        checked.push_back(i);
+      }
+    }
+
+    // inputs of all transactions are checked at once, so that their signatures are verified in parallel
+    std::vector<const Transaction*> checkedTxs;
+    for (size_t i : checked) {
+      checkedTxs.push_back(&txs[i]);
+    }
+
+    std::vector<BlockInfo> maxUsedBlocks;
+    std::vector<bool> inputsValid;
+    m_validator.checkTransactionsInputs(checkedTxs, maxUsedBlocks, inputsValid);
+
+    std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
+    for (size_t j = 0; j < checked.size(); ++j) {
+      const size_t i = checked[j];
+      insertTransaction(txs[i], ids[i], blobSizes[i], tvcs[i], keptByBlock, fees[i], fusion[i] != 0, inputsValid[j], maxUsedBlocks[j]);
+    }
+  }
+  //---------------------------------------------------------------------------------
+  bool tx_memory_pool::checkTransaction(const Transaction &tx, const Crypto::Hash &id, size_t blobSize, tx_verification_context& tvc, bool keptByBlock, uint64_t& fee, bool& isFusionTransaction) {
     if(!keptByBlock && blobSize > parameters::MAX_TRANSACTION_SIZE_LIMIT) {
       logger(INFO) << "transaction is too big (" << blobSize << ")bytes for current transaction flow, tx_id: " << id;
       tvc.m_verification_failed = true;
@@ -125,8 +172,8 @@ namespace TycheCash {
       return false;
     }
 
-    const uint64_t fee = inputs_amount - outputs_amount;
-    bool isFusionTransaction = fee == 0 && m_currency.isFusionTransaction(tx, blobSize);
+    fee = inputs_amount - outputs_amount;
+    isFusionTransaction = fee == 0 && m_currency.isFusionTransaction(tx, blobSize);
     if (!keptByBlock && !isFusionTransaction && fee < m_currency.minimumFee()) {
       logger(INFO) << "transaction fee is not enough: " << m_currency.formatAmount(fee) <<
         ", minimum fee: " << m_currency.formatAmount(m_currency.minimumFee());
@@ -152,11 +199,10 @@ namespace TycheCash {
       }
     }
 
-    BlockInfo maxUsedBlock;
-
-    // check inputs
-    bool inputsValid = m_validator.checkTransactionInputs(tx, maxUsedBlock);
-
+    return true;
+  }
+  //---------------------------------------------------------------------------------
+  bool tx_memory_pool::insertTransaction(const Transaction &tx, const Crypto::Hash &id, size_t blobSize, tx_verification_context& tvc, bool keptByBlock, uint64_t fee, bool isFusionTransaction, bool inputsValid, BlockInfo maxUsedBlock) {
     if (!inputsValid) {
       if (!keptByBlock) {
         logger(INFO) << "tx used wrong inputs, rejected";
@@ -179,6 +225,13 @@ namespace TycheCash {
 
     std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
 
+    // inputs could be spent by another transaction while this one was checked
+    if (!keptByBlock && haveSpentInputs(tx)) {
+      logger(INFO) << "Transaction with id= " << id << " used already spent inputs";
+      tvc.m_verification_failed = true;
+      return false;
+    }
+
     if (!keptByBlock && m_recentlyDeletedTransactions.find(id) != m_recentlyDeletedTransactions.end()) {
       logger(INFO) << "Trying to add recently deleted transaction. Ignore: " << id;
       tvc.m_verification_failed = false;
@@ -222,7 +275,6 @@ namespace TycheCash {
     //succeed
     return true;
   }
-
   //---------------------------------------------------------------------------------
   bool tx_memory_pool::add_tx(const Transaction &tx, tx_verification_context& tvc, bool keeped_by_block) {
     Crypto::Hash h = NULL_HASH;
@@ -86,6 +86,9 @@ namespace TycheCash {
     bool have_tx(const Crypto::Hash &id) const;
     bool add_tx(const Transaction &tx, const Crypto::Hash &id, size_t blobSize, tx_verification_context& tvc, bool keeped_by_block);
     bool add_tx(const Transaction &tx, tx_verification_context& tvc, bool keeped_by_block);
+    // Adds several transactions taking the pool lock once, tvcs[i] is the result for txs[i]
+    void add_txs(const std::vector<Transaction>& txs, const std::vector<Crypto::Hash>& ids, const std::vector<size_t>& blobSizes,
+      std::vector<tx_verification_context>& tvcs, bool keptByBlock);
     //gets tx and remove it from pool
     bool take_tx(const Crypto::Hash &id, Transaction &tx, size_t& blobSize, uint64_t& fee);
 
@@ -172,6 +175,12 @@ namespace TycheCash {
     typedef std::unordered_map<Crypto::KeyImage, std::unordered_set<Crypto::Hash> > key_images_container;
 
 
+    // checks which don't need the blockchain, the rest of add_tx
+    bool checkTransaction(const Transaction &tx, const Crypto::Hash &id, size_t blobSize, tx_verification_context& tvc, bool keptByBlock,
+      uint64_t& fee, bool& isFusionTransaction);
+    bool insertTransaction(const Transaction &tx, const Crypto::Hash &id, size_t blobSize, tx_verification_context& tvc, bool keptByBlock,
+      uint64_t fee, bool isFusionTransaction, bool inputsValid, BlockInfo maxUsedBlock);
+
     // double spending checking
     bool addTransactionInputs(const Crypto::Hash& id, const Transaction& tx, bool keptByBlock);
     bool haveSpentInputs(const Transaction& tx) const;
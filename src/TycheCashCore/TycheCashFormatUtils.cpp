@@ -474,6 +474,24 @@ bool get_block_longhash(cn_context &context, const Block& b, Hash& res) {
   return true;
 }
 
+bool get_block_longhashes(cn_context* const* contexts, const Block* blocks, size_t count, Hash* res) {
+  assert(count <= SLOW_HASH_MAX_WAYS);
+  BinaryArray blobs[SLOW_HASH_MAX_WAYS];
+  const void* data[SLOW_HASH_MAX_WAYS];
+  size_t lengths[SLOW_HASH_MAX_WAYS];
+  for (size_t i = 0; i < count; ++i) {
+    if (!get_block_hashing_blob(blocks[i], blobs[i])) {
+      return false;
+    }
+
+    data[i] = blobs[i].data();
+    lengths[i] = blobs[i].size();
+  }
+
+  cn_slow_hash_multi(contexts, data, lengths, res, count);
+  return true;
+}
+
 std::vector<uint32_t> relative_output_offsets_to_absolute(const std::vector<uint32_t>& off) {
   std::vector<uint32_t> res = off;
   for (size_t i = 1; i < res.size(); i++)
@@ -60,6 +60,8 @@ bool get_aux_block_header_hash(const Block& b, Crypto::Hash& res);
 bool get_block_hash(const Block& b, Crypto::Hash& res);
 Crypto::Hash get_block_hash(const Block& b);
 bool get_block_longhash(Crypto::cn_context &context, const Block& b, Crypto::Hash& res);
+// Hashes up to Crypto::SLOW_HASH_MAX_WAYS blocks at once, each one with its own context
+bool get_block_longhashes(Crypto::cn_context* const* contexts, const Block* blocks, size_t count, Crypto::Hash* res);
 bool get_inputs_money_amount(const Transaction& tx, uint64_t& money);
 uint64_t get_outs_money_amount(const Transaction& tx);
 bool check_inputs_types_supported(const TransactionPrefix& tx);
@@ -0,0 +1,152 @@
+// Copyright (c) 2017-2018 The TycheCash developers  ; Originally forked from Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "BlockDownloadScheduler.h"
+
+#include <algorithm>
+
+namespace TycheCash {
+
+const BlockDownloadScheduler::Clock::duration BlockDownloadScheduler::SYNC_SPEED_WINDOW = std::chrono::seconds(10);
+
+BlockDownloadScheduler::BlockDownloadScheduler(size_t maxParkedBlocks) : m_maxParkedBlocks(maxParkedBlocks) {
+}
+
+bool BlockDownloadScheduler::canReserve() const {
+  return m_parkedBlocks.size() < m_maxParkedBlocks;
+}
+
+bool BlockDownloadScheduler::reserve(const Crypto::Hash& blockHash, const boost::uuids::uuid& connectionId) {
+  if (m_parkedBlocks.count(blockHash) != 0) {
+    return false;
+  }
+
+  auto result = m_reservedBlocks.insert(std::make_pair(blockHash, connectionId));
+  return result.second || result.first->second == connectionId;
+}
+
+void BlockDownloadScheduler::received(const Crypto::Hash& blockHash) {
+  m_reservedBlocks.erase(blockHash);
+}
+
+bool BlockDownloadScheduler::release(const boost::uuids::uuid& connectionId) {
+  bool released = false;
+  for (auto it = m_reservedBlocks.begin(); it != m_reservedBlocks.end();) {
+    if (it->second == connectionId) {
+      it = m_reservedBlocks.erase(it);
+      released = true;
+    } else {
+      ++it;
+    }
+  }
+
+  m_waitingConnections.erase(std::remove(m_waitingConnections.begin(), m_waitingConnections.end(), connectionId), m_waitingConnections.end());
+  return released;
+}
+
+bool BlockDownloadScheduler::isPending(const Crypto::Hash& blockHash) const {
+  return m_reservedBlocks.count(blockHash) != 0 || m_parkedBlocks.count(blockHash) != 0;
+}
+
+bool BlockDownloadScheduler::hasPendingBlocks() const {
+  return !m_reservedBlocks.empty() || !m_parkedBlocks.empty();
+}
+
+size_t BlockDownloadScheduler::reservedBlocksCount() const {
+  return m_reservedBlocks.size();
+}
+
+void BlockDownloadScheduler::park(DownloadedSpan&& span) {
+  if (span.blocks.empty()) {
+    return;
+  }
+
+  const Crypto::Hash previousBlockHash = span.blocks.front().block.previousBlockHash;
+  auto it = m_parkedSpans.find(previousBlockHash);
+  if (it != m_parkedSpans.end()) {
+    // the same span was downloaded twice, keep the first copy
+    return;
+  }
+
+  for (const DownloadedBlock& block : span.blocks) {
+    m_parkedBlocks.insert(block.hash);
+  }
+
+  m_parkedSpans.insert(std::make_pair(previousBlockHash, std::move(span)));
+}
+
+bool BlockDownloadScheduler::takeNext(const Crypto::Hash& previousBlockHash, DownloadedSpan& span) {
+  auto it = m_parkedSpans.find(previousBlockHash);
+  if (it == m_parkedSpans.end()) {
+    return false;
+  }
+
+  span = std::move(it->second);
+  m_parkedSpans.erase(it);
+  return true;
+}
+
+void BlockDownloadScheduler::applied(const DownloadedSpan& span) {
+  for (const DownloadedBlock& block : span.blocks) {
+    m_parkedBlocks.erase(block.hash);
+  }
+}
+
+size_t BlockDownloadScheduler::parkedBlocksCount() const {
+  return m_parkedBlocks.size();
+}
+
+void BlockDownloadScheduler::dropParked() {
+  m_parkedSpans.clear();
+  m_parkedBlocks.clear();
+}
+
+void BlockDownloadScheduler::addWaiting(const boost::uuids::uuid& connectionId) {
+  if (std::find(m_waitingConnections.begin(), m_waitingConnections.end(), connectionId) == m_waitingConnections.end()) {
+    m_waitingConnections.push_back(connectionId);
+  }
+}
+
+std::vector<boost::uuids::uuid> BlockDownloadScheduler::takeWaiting() {
+  std::vector<boost::uuids::uuid> result;
+  result.swap(m_waitingConnections);
+  return result;
+}
+
+void BlockDownloadScheduler::addReceivedBytes(size_t bytes, Clock::time_point now) {
+  addSample(0, bytes, now);
+}
+
+void BlockDownloadScheduler::addAppliedBlocks(size_t count, Clock::time_point now) {
+  addSample(count, 0, now);
+}
+
+void BlockDownloadScheduler::getSyncSpeed(double& blocksPerSecond, double& bytesPerSecond, Clock::time_point now) const {
+  size_t blocks = 0;
+  size_t bytes = 0;
+  for (const Sample& sample : m_samples) {
+    if (now - sample.time <= SYNC_SPEED_WINDOW) {
+      blocks += sample.blocks;
+      bytes += sample.bytes;
+    }
+  }
+
+  const double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(SYNC_SPEED_WINDOW).count();
+  blocksPerSecond = blocks / seconds;
+  bytesPerSecond = bytes / seconds;
+}
+
+void BlockDownloadScheduler::addSample(size_t blocks, size_t bytes, Clock::time_point now) {
+  dropOldSamples(now);
+  Sample sample = { now, blocks, bytes };
+  m_samples.push_back(sample);
+}
+
+void BlockDownloadScheduler::dropOldSamples(Clock::time_point now) {
+  while (!m_samples.empty() && now - m_samples.front().time > SYNC_SPEED_WINDOW) {
+    m_samples.pop_front();
+  }
+}
+
+}
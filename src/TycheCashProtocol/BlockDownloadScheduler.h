@@ -0,0 +1,93 @@
+// Copyright (c) 2017-2018 The TycheCash developers  ; Originally forked from Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <boost/uuid/uuid.hpp>
+
+#include "crypto/hash.h"
+#include "TycheCash.h"
+
+namespace TycheCash {
+
+// Block decoded and hashed on a worker thread, ready to be applied to the blockchain
+struct DownloadedBlock {
+  Block block;
+  Crypto::Hash hash;
+  std::vector<Transaction> transactions;
+  std::vector<Crypto::Hash> transactionHashes;
+  std::vector<size_t> transactionSizes;
+};
+
+// Consecutive blocks received from one connection in a single NOTIFY_RESPONSE_GET_OBJECTS
+struct DownloadedSpan {
+  boost::uuids::uuid connectionId;
+  std::vector<DownloadedBlock> blocks;
+};
+
+// Coordinates block downloading during synchronization. Every needed block is requested from a single connection,
+// so that different connections download different spans of the chain at once. Downloaded spans are parked and handed
+// out in blockchain order, their blocks stay pending until applied. Not thread safe, used from the dispatcher thread.
+class BlockDownloadScheduler {
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  explicit BlockDownloadScheduler(size_t maxParkedBlocks);
+
+  // Returns false if no more blocks should be requested until parked ones are applied
+  bool canReserve() const;
+  // Returns false if the block is already requested from another connection or parked
+  bool reserve(const Crypto::Hash& blockHash, const boost::uuids::uuid& connectionId);
+  void received(const Crypto::Hash& blockHash);
+  // Drops reservations of a closed connection, returns true if it had any
+  bool release(const boost::uuids::uuid& connectionId);
+  bool isPending(const Crypto::Hash& blockHash) const;
+  bool hasPendingBlocks() const;
+  size_t reservedBlocksCount() const;
+
+  void park(DownloadedSpan&& span);
+  // Takes the parked span whose first block is built on the given one
+  bool takeNext(const Crypto::Hash& previousBlockHash, DownloadedSpan& span);
+  // Called when the span returned by takeNext is applied to the blockchain or rejected
+  void applied(const DownloadedSpan& span);
+  // Blocks which are downloaded but not applied yet
+  size_t parkedBlocksCount() const;
+  void dropParked();
+
+  // Connections which have nothing to request until other connections make progress
+  void addWaiting(const boost::uuids::uuid& connectionId);
+  std::vector<boost::uuids::uuid> takeWaiting();
+
+  void addReceivedBytes(size_t bytes, Clock::time_point now = Clock::now());
+  void addAppliedBlocks(size_t count, Clock::time_point now = Clock::now());
+  // Average throughput over the last SYNC_SPEED_WINDOW
+  void getSyncSpeed(double& blocksPerSecond, double& bytesPerSecond, Clock::time_point now = Clock::now()) const;
+
+  static const Clock::duration SYNC_SPEED_WINDOW;
+
+private:
+  struct Sample {
+    Clock::time_point time;
+    size_t blocks;
+    size_t bytes;
+  };
+
+  void addSample(size_t blocks, size_t bytes, Clock::time_point now);
+  void dropOldSamples(Clock::time_point now);
+
+  const size_t m_maxParkedBlocks;
+  std::unordered_map<Crypto::Hash, boost::uuids::uuid> m_reservedBlocks;
+  std::unordered_map<Crypto::Hash, DownloadedSpan> m_parkedSpans;
+  std::unordered_set<Crypto::Hash> m_parkedBlocks;
+  std::vector<boost::uuids::uuid> m_waitingConnections;
+  std::deque<Sample> m_samples;
+};
+
+}
@@ -18,6 +18,8 @@ public:
   virtual uint32_t getObservedHeight() const = 0;
   virtual size_t getPeerCount() const = 0;
   virtual bool isSynchronized() const = 0;
+  // Throughput of blockchain synchronization over the last few seconds
+  virtual void getSyncSpeed(double& blocksPerSecond, double& bytesPerSecond) const = 0;
 };
 
 } //namespace TycheCash
@@ -0,0 +1,96 @@
+// Copyright (c) 2017-2018 The TycheCash developers  ; Originally forked from Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "TransactionInventory.h"
+
+#include <algorithm>
+
+namespace TycheCash {
+
+KnownInventory::KnownInventory(size_t capacity) : m_capacity(capacity) {
+}
+
+bool KnownInventory::insert(const Crypto::Hash& hash) {
+  if (!m_hashes.insert(hash).second) {
+    return false;
+  }
+
+  m_order.push_back(hash);
+  if (m_order.size() > m_capacity) {
+    m_hashes.erase(m_order.front());
+    m_order.pop_front();
+  }
+
+  return true;
+}
+
+bool KnownInventory::contains(const Crypto::Hash& hash) const {
+  return m_hashes.count(hash) != 0;
+}
+
+size_t KnownInventory::size() const {
+  return m_hashes.size();
+}
+
+TransactionRequests::TransactionRequests(Clock::duration timeout) : m_timeout(timeout) {
+}
+
+bool TransactionRequests::announced(const Crypto::Hash& hash, const boost::uuids::uuid& connectionId, Clock::time_point now) {
+  auto it = m_requests.find(hash);
+  if (it == m_requests.end()) {
+    Request request;
+    request.connectionId = connectionId;
+    request.deadline = now + m_timeout;
+    m_requests.insert(std::make_pair(hash, std::move(request)));
+    return true;
+  }
+
+  Request& request = it->second;
+  if (request.connectionId != connectionId &&
+      std::find(request.announcers.begin(), request.announcers.end(), connectionId) == request.announcers.end()) {
+    request.announcers.push_back(connectionId);
+  }
+
+  return false;
+}
+
+void TransactionRequests::received(const Crypto::Hash& hash) {
+  m_requests.erase(hash);
+}
+
+void TransactionRequests::release(const boost::uuids::uuid& connectionId) {
+  for (auto& item : m_requests) {
+    Request& request = item.second;
+    request.announcers.erase(std::remove(request.announcers.begin(), request.announcers.end(), connectionId), request.announcers.end());
+    if (request.connectionId == connectionId) {
+      request.deadline = Clock::time_point();
+    }
+  }
+}
+
+std::map<boost::uuids::uuid, std::vector<Crypto::Hash>> TransactionRequests::takeExpired(Clock::time_point now) {
+  std::map<boost::uuids::uuid, std::vector<Crypto::Hash>> result;
+  for (auto it = m_requests.begin(); it != m_requests.end();) {
+    Request& request = it->second;
+    if (now < request.deadline) {
+      ++it;
+    } else if (request.announcers.empty()) {
+      it = m_requests.erase(it);
+    } else {
+      request.connectionId = request.announcers.front();
+      request.announcers.pop_front();
+      request.deadline = now + m_timeout;
+      result[request.connectionId].push_back(it->first);
+      ++it;
+    }
+  }
+
+  return result;
+}
+
+size_t TransactionRequests::size() const {
+  return m_requests.size();
+}
+
+}
@@ -0,0 +1,66 @@
+// Copyright (c) 2017-2018 The TycheCash developers  ; Originally forked from Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <boost/uuid/uuid.hpp>
+
+#include "crypto/hash.h"
+
+namespace TycheCash {
+
+// Transaction hashes a peer is known to have, either because it sent or announced them or because they were sent to it.
+// Holds up to the given number of hashes, the oldest ones are forgotten first.
+class KnownInventory {
+public:
+  explicit KnownInventory(size_t capacity);
+
+  // Returns false if the hash is already known
+  bool insert(const Crypto::Hash& hash);
+  bool contains(const Crypto::Hash& hash) const;
+  size_t size() const;
+
+private:
+  size_t m_capacity;
+  std::unordered_set<Crypto::Hash> m_hashes;
+  std::deque<Crypto::Hash> m_order;
+};
+
+// Announced transactions which are being fetched. Every transaction is requested from a single connection,
+// if it doesn't arrive in time it is requested from the next connection which announced it.
+// Not thread safe, used from the dispatcher thread.
+class TransactionRequests {
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  explicit TransactionRequests(Clock::duration timeout);
+
+  // Returns true if the transaction should be requested from the announcing connection now
+  bool announced(const Crypto::Hash& hash, const boost::uuids::uuid& connectionId, Clock::time_point now = Clock::now());
+  void received(const Crypto::Hash& hash);
+  // Forgets announcements of a closed connection, its pending requests expire at once
+  void release(const boost::uuids::uuid& connectionId);
+  // Reassigns expired requests to the next announcing connection, returns the transactions to request from each one
+  std::map<boost::uuids::uuid, std::vector<Crypto::Hash>> takeExpired(Clock::time_point now = Clock::now());
+  size_t size() const;
+
+private:
+  struct Request {
+    boost::uuids::uuid connectionId;
+    Clock::time_point deadline;
+    std::deque<boost::uuids::uuid> announcers;
+  };
+
+  const Clock::duration m_timeout;
+  std::unordered_map<Crypto::Hash, Request> m_requests;
+};
+
+}
@@ -196,4 +196,36 @@ namespace TycheCash
     const static int ID = BC_COMMANDS_POOL_BASE + 8;
     typedef NOTIFY_REQUEST_TX_POOL_request request;
   };
+
+  /************************************************************************/
+  /* Sent instead of NOTIFY_NEW_TRANSACTIONS to peers of P2PProtocolVersion::V2 and above */
+  /************************************************************************/
+  struct NOTIFY_TX_INVENTORY_request {
+    std::vector<Crypto::Hash> txs;
+
+    void serialize(ISerializer& s) {
+      serializeAsBinary(txs, "txs", s);
+    }
+  };
+
+  struct NOTIFY_TX_INVENTORY {
+    const static int ID = BC_COMMANDS_POOL_BASE + 9;
+    typedef NOTIFY_TX_INVENTORY_request request;
+  };
+
+  /************************************************************************/
+  /* Requests announced transactions, they are sent back with NOTIFY_NEW_TRANSACTIONS */
+  /************************************************************************/
+  struct NOTIFY_REQUEST_TXS_request {
+    std::vector<Crypto::Hash> txs;
+
+    void serialize(ISerializer& s) {
+      serializeAsBinary(txs, "txs", s);
+    }
+  };
+
+  struct NOTIFY_REQUEST_TXS {
+    const static int ID = BC_COMMANDS_POOL_BASE + 10;
+    typedef NOTIFY_REQUEST_TXS_request request;
+  };
 }
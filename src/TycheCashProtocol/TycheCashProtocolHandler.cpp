@@ -4,10 +4,12 @@
 
 #include "TycheCashProtocolHandler.h"
 
+#include <algorithm>
 #include <future>
 #include <boost/scope_exit.hpp>
 #include <boost/uuid/uuid_io.hpp>
 #include <System/Dispatcher.h>
+#include <System/RemoteContext.h>
 
 #include "TycheCashCore/TycheCashBasicImpl.h"
 #include "TycheCashCore/TycheCashFormatUtils.h"
@@ -33,6 +35,41 @@ void relay_post_notify(IP2pEndpoint& p2p, typename t_parametr::request& arg, con
   p2p.relay_notify_to_all(t_parametr::ID, LevinProtocol::encode(arg), excludeConnection);
 }
 
+// Called on worker threads, returns error description or empty string
+std::string decodeBlock(const block_complete_entry& entry, size_t maxBlockBlobSize, size_t maxTxSize, DownloadedBlock& result) {
+  try {
+    if (entry.block.size() > maxBlockBlobSize) {
+      return "block blob is too big: " + std::to_string(entry.block.size()) + " bytes";
+    }
+
+    if (!fromBinaryArray(result.block, asBinaryArray(entry.block))) {
+      return "failed to parse block: \r\n" + toHex(asBinaryArray(entry.block));
+    }
+
+    result.hash = get_block_hash(result.block);
+    result.transactions.resize(entry.txs.size());
+    result.transactionHashes.resize(entry.txs.size());
+    result.transactionSizes.resize(entry.txs.size());
+    for (size_t i = 0; i < entry.txs.size(); ++i) {
+      const BinaryArray transactionBlob = asBinaryArray(entry.txs[i]);
+      if (transactionBlob.size() > maxTxSize) {
+        return "transaction blob is too big: " + std::to_string(transactionBlob.size()) + " bytes";
+      }
+
+      Crypto::Hash prefixHash;
+      if (!parseAndValidateTransactionFromBinaryArray(transactionBlob, result.transactions[i], result.transactionHashes[i], prefixHash)) {
+        return "failed to parse transaction " + Common::podToHex(getBinaryArrayHash(transactionBlob));
+      }
+
+      result.transactionSizes[i] = transactionBlob.size();
+    }
+  } catch (std::exception& e) {
+    return std::string("failed to decode block: ") + e.what();
+  }
+
+  return std::string();
+}
+
 }
 
 TycheCashProtocolHandler::TycheCashProtocolHandler(const Currency& currency, System::Dispatcher& dispatcher, ICore& rcore, IP2pEndpoint* p_net_layout, Logging::ILogger& log) :
@@ -44,6 +81,10 @@ TycheCashProtocolHandler::TycheCashProtocolHandler(const Currency& currency, Sys
   m_stop(false),
   m_observedHeight(0),
   m_peersCount(0),
+  m_decodingPool(0),
+  m_downloadScheduler(BLOCKS_SYNCHRONIZING_MAX_PARKED_COUNT),
+  m_applyingBlocks(false),
+  m_transactionRequests(std::chrono::seconds(P2P_TX_REQUEST_TIMEOUT)),
   logger(log, "protocol") {
   
   if (!m_p2p) {
@@ -85,6 +126,13 @@ void TycheCashProtocolHandler::onConnectionClosed(TycheCashConnectionContext& co
     m_peersCount--;
     m_observerManager.notify(&ITycheCashProtocolObserver::peerCountUpdated, m_peersCount.load());
   }
+
+  m_transactionRequests.release(context.m_connection_id);
+
+  // blocks reserved by the closed connection can be requested from the others now
+  if (m_downloadScheduler.release(context.m_connection_id)) {
+    wakeWaitingConnections();
+  }
 }
 
 void TycheCashProtocolHandler::stop() {
@@ -212,6 +260,8 @@ int TycheCashProtocolHandler::handleCommand(bool is_notify, int command, const B
     HANDLE_NOTIFY(NOTIFY_REQUEST_CHAIN, &TycheCashProtocolHandler::handle_request_chain)
     HANDLE_NOTIFY(NOTIFY_RESPONSE_CHAIN_ENTRY, &TycheCashProtocolHandler::handle_response_chain_entry)
     HANDLE_NOTIFY(NOTIFY_REQUEST_TX_POOL, &TycheCashProtocolHandler::handleRequestTxPool)
+    HANDLE_NOTIFY(NOTIFY_TX_INVENTORY, &TycheCashProtocolHandler::handleNotifyTxInventory)
+    HANDLE_NOTIFY(NOTIFY_REQUEST_TXS, &TycheCashProtocolHandler::handleRequestTxs)
 
   default:
     handled = false;
@@ -233,9 +283,14 @@ int TycheCashProtocolHandler::handle_notify_new_block(int command, NOTIFY_NEW_BL
     return 1;
   }
 
-  for (auto tx_blob_it = arg.b.txs.begin(); tx_blob_it != arg.b.txs.end(); tx_blob_it++) {
-    TycheCash::tx_verification_context tvc = boost::value_initialized<decltype(tvc)>();
-    m_core.handle_incoming_tx(asBinaryArray(*tx_blob_it), tvc, true);
+  std::vector<BinaryArray> transactionBlobs;
+  for (const std::string& tx_blob : arg.b.txs) {
+    transactionBlobs.push_back(asBinaryArray(tx_blob));
+  }
+
+  std::vector<tx_verification_context> tvcs;
+  m_core.handleIncomingTransactions(transactionBlobs, tvcs, true);
+  for (const tx_verification_context& tvc : tvcs) {
     if (tvc.m_verification_failed) {
       logger(Logging::INFO) << context << "Block verification failed: transaction verification failed, dropping connection";
       context.m_state = TycheCashConnectionContext::state_shutdown;
@@ -275,27 +330,92 @@ int TycheCashProtocolHandler::handle_notify_new_transactions(int command, NOTIFY
   if (context.m_state != TycheCashConnectionContext::state_normal)
     return 1;
 
-  for (auto tx_blob_it = arg.txs.begin(); tx_blob_it != arg.txs.end();) {
-    TycheCash::tx_verification_context tvc = boost::value_initialized<decltype(tvc)>();
-    m_core.handle_incoming_tx(asBinaryArray(*tx_blob_it), tvc, false);
-    if (tvc.m_verification_failed) {
+  std::vector<BinaryArray> transactionBlobs;
+  std::vector<Crypto::Hash> transactionHashes;
+  for (const std::string& tx_blob : arg.txs) {
+    transactionBlobs.push_back(asBinaryArray(tx_blob));
+    transactionHashes.push_back(getBinaryArrayHash(transactionBlobs.back()));
+    context.m_knownTransactions.insert(transactionHashes.back());
+    m_transactionRequests.received(transactionHashes.back());
+  }
+
+  std::vector<tx_verification_context> tvcs;
+  m_core.handleIncomingTransactions(transactionBlobs, tvcs, false);
+
+  std::vector<Crypto::Hash> relayedHashes;
+  std::vector<std::string> relayedTransactions;
+  for (size_t i = 0; i < tvcs.size(); ++i) {
+    if (tvcs[i].m_verification_failed) {
       logger(Logging::INFO) << context << "Tx verification failed";
-    }
-    if (!tvc.m_verification_failed && tvc.m_should_be_relayed) {
-      ++tx_blob_it;
-    } else {
-      tx_blob_it = arg.txs.erase(tx_blob_it);
+    } else if (tvcs[i].m_should_be_relayed) {
+      relayedHashes.push_back(transactionHashes[i]);
+      relayedTransactions.push_back(std::move(arg.txs[i]));
     }
   }
 
-  if (arg.txs.size()) {
-    //TODO: add announce usage here
-    relay_post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, arg, &context.m_connection_id);
+  if (!relayedHashes.empty()) {
+    relayTransactions(relayedHashes, relayedTransactions, &context.m_connection_id);
   }
 
   return true;
 }
 
+int TycheCashProtocolHandler::handleNotifyTxInventory(int command, NOTIFY_TX_INVENTORY::request& arg, TycheCashConnectionContext& context) {
+  logger(Logging::TRACE) << context << "NOTIFY_TX_INVENTORY: txs.size() = " << arg.txs.size();
+  if (context.m_state != TycheCashConnectionContext::state_normal) {
+    return 1;
+  }
+
+  if (arg.txs.size() > P2P_TX_INVENTORY_MAX_COUNT) {
+    logger(Logging::ERROR) << context << "NOTIFY_TX_INVENTORY: too many transactions announced: " << arg.txs.size() << ", dropping connection";
+    context.m_state = TycheCashConnectionContext::state_shutdown;
+    return 1;
+  }
+
+  std::vector<Crypto::Hash> missingTransactions;
+  for (const Crypto::Hash& hash : arg.txs) {
+    context.m_knownTransactions.insert(hash);
+    if (!m_core.haveTransaction(hash) && m_transactionRequests.announced(hash, context.m_connection_id)) {
+      missingTransactions.push_back(hash);
+    }
+  }
+
+  if (!missingTransactions.empty()) {
+    requestTransactions(missingTransactions, context);
+  }
+
+  return 1;
+}
+
+int TycheCashProtocolHandler::handleRequestTxs(int command, NOTIFY_REQUEST_TXS::request& arg, TycheCashConnectionContext& context) {
+  logger(Logging::TRACE) << context << "NOTIFY_REQUEST_TXS: txs.size() = " << arg.txs.size();
+  if (arg.txs.size() > P2P_TX_INVENTORY_MAX_COUNT) {
+    logger(Logging::ERROR) << context << "NOTIFY_REQUEST_TXS: too many transactions requested: " << arg.txs.size() << ", dropping connection";
+    context.m_state = TycheCashConnectionContext::state_shutdown;
+    return 1;
+  }
+
+  std::list<Transaction> transactions;
+  std::list<Crypto::Hash> missedTransactions;
+  m_core.getTransactions(arg.txs, transactions, missedTransactions, true);
+  if (transactions.empty()) {
+    return 1;
+  }
+
+  NOTIFY_NEW_TRANSACTIONS::request notification;
+  for (const Transaction& tx : transactions) {
+    BinaryArray blob = toBinaryArray(tx);
+    context.m_knownTransactions.insert(getBinaryArrayHash(blob));
+    notification.txs.push_back(asString(blob));
+  }
+
+  if (!post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, notification, context)) {
+    logger(Logging::WARNING, Logging::BRIGHT_YELLOW) << "Failed to post notification NOTIFY_NEW_TRANSACTIONS to " << context.m_connection_id;
+  }
+
+  return 1;
+}
+
 int TycheCashProtocolHandler::handle_request_get_objects(int command, NOTIFY_REQUEST_GET_OBJECTS::request& arg, TycheCashConnectionContext& context) {
   logger(Logging::TRACE) << context << "NOTIFY_REQUEST_GET_OBJECTS";
   NOTIFY_RESPONSE_GET_OBJECTS::request rsp;
@@ -323,29 +443,31 @@ int TycheCashProtocolHandler::handle_response_get_objects(int command, NOTIFY_RE
 
   context.m_remote_blockchain_height = arg.current_blockchain_height;
 
+  DownloadedSpan span;
+  if (!decodeObjects(context, arg.blocks, span)) {
+    return 1;
+  }
+
   size_t count = 0;
-  for (const block_complete_entry& block_entry : arg.blocks) {
+  for (const DownloadedBlock& downloadedBlock : span.blocks) {
     ++count;
-    Block b;
-    if (!fromBinaryArray(b, asBinaryArray(block_entry.block))) {
-      logger(Logging::ERROR) << context << "sent wrong block: failed to parse and validate block: \r\n"
-        << toHex(asBinaryArray(block_entry.block)) << "\r\n dropping connection";
-      context.m_state = TycheCashConnectionContext::state_shutdown;
-      return 1;
-    }
+    const Block& b = downloadedBlock.block;
 
     //to avoid concurrency in core between connections, suspend connections which delivered block later then first one
     if (count == 2) {
-      if (m_core.have_block(get_block_hash(b))) {
+      if (m_core.have_block(downloadedBlock.hash)) {
         context.m_state = TycheCashConnectionContext::state_idle;
         context.m_needed_objects.clear();
         context.m_requested_objects.clear();
+        if (m_downloadScheduler.release(context.m_connection_id)) {
+          wakeWaitingConnections();
+        }
         logger(Logging::DEBUGGING) << context << "Connection set to idle state.";
         return 1;
       }
     }
 
-    auto blockHash = get_block_hash(b);
+    auto blockHash = downloadedBlock.hash;
     auto req_it = context.m_requested_objects.find(blockHash);
     if (req_it == context.m_requested_objects.end()) {
       logger(Logging::ERROR) << context << "sent wrong NOTIFY_RESPONSE_GET_OBJECTS: block with id=" << Common::podToHex(blockHash)
@@ -353,9 +475,9 @@ int TycheCashProtocolHandler::handle_response_get_objects(int command, NOTIFY_RE
       context.m_state = TycheCashConnectionContext::state_shutdown;
       return 1;
     }
-    if (b.transactionHashes.size() != block_entry.txs.size()) {
+    if (b.transactionHashes.size() != downloadedBlock.transactions.size()) {
       logger(Logging::ERROR) << context << "sent wrong NOTIFY_RESPONSE_GET_OBJECTS: block with id=" << Common::podToHex(blockHash)
-        << ", transactionHashes.size()=" << b.transactionHashes.size() << " mismatch with block_complete_entry.m_txs.size()=" << block_entry.txs.size() << ", dropping connection";
+        << ", transactionHashes.size()=" << b.transactionHashes.size() << " mismatch with block_complete_entry.m_txs.size()=" << downloadedBlock.transactions.size() << ", dropping connection";
       context.m_state = TycheCashConnectionContext::state_shutdown;
       return 1;
     }
@@ -371,77 +493,213 @@ int TycheCashProtocolHandler::handle_response_get_objects(int command, NOTIFY_RE
     return 1;
   }
 
-  {
-    m_core.pause_mining();
+  size_t receivedBytes = 0;
+  for (const block_complete_entry& block_entry : arg.blocks) {
+    receivedBytes += block_entry.block.size();
+    for (auto& tx_blob : block_entry.txs) {
+      receivedBytes += tx_blob.size();
+    }
+  }
 
-    BOOST_SCOPE_EXIT_ALL(this) { m_core.update_block_template_and_resume_mining(); };
+  for (const DownloadedBlock& downloadedBlock : span.blocks) {
+    m_downloadScheduler.received(downloadedBlock.hash);
+  }
 
-    int result = processObjects(context, arg.blocks);
-    if (result != 0) {
-      return result;
+  {
+    std::lock_guard<std::mutex> lock(m_syncSpeedMutex);
+    m_downloadScheduler.addReceivedBytes(receivedBytes);
+  }
+
+  if (span.blocks.empty()) {
+    if (!m_stop && context.m_state == TycheCashConnectionContext::state_synchronizing) {
+      request_missing_objects(context, true);
     }
+
+    return 1;
   }
 
-  uint32_t height;
-  Crypto::Hash top;
-  m_core.get_blockchain_top(height, top);
-  logger(DEBUGGING, BRIGHT_GREEN) << "Local blockchain updated, new height = " << height;
+  // request the next span before applying this one, so that the connection downloads while the core validates
+  bool requested = false;
+  if (!m_stop && context.m_state == TycheCashConnectionContext::state_synchronizing && !context.m_needed_objects.empty()) {
+    request_missing_objects(context, true);
+    requested = true;
+  }
+
+  const Crypto::Hash previousBlockHash = span.blocks.front().block.previousBlockHash;
+  m_downloadScheduler.park(std::move(span));
+  if (!m_applyingBlocks && m_core.have_block(previousBlockHash)) {
+    applyParkedBlocks(previousBlockHash);
+  } else {
+    logger(Logging::TRACE) << context << "Blocks parked until preceding blocks are applied, parked blocks: " << m_downloadScheduler.parkedBlocksCount();
+  }
 
-  if (!m_stop && context.m_state == TycheCashConnectionContext::state_synchronizing) {
+  if (!requested && !m_stop && context.m_state == TycheCashConnectionContext::state_synchronizing) {
     request_missing_objects(context, true);
   }
 
   return 1;
 }
 
-int TycheCashProtocolHandler::processObjects(TycheCashConnectionContext& context, const std::vector<block_complete_entry>& blocks) {
+bool TycheCashProtocolHandler::decodeObjects(TycheCashConnectionContext& context, const std::vector<block_complete_entry>& blocks, DownloadedSpan& span) {
+  span.connectionId = context.m_connection_id;
+  span.blocks.resize(blocks.size());
+  std::vector<std::string> errors(blocks.size());
+
+  const size_t maxBlockBlobSize = m_currency.maxBlockBlobSize();
+  const size_t maxTxSize = m_currency.maxTxSize();
+  System::RemoteContext<void> decoding(m_dispatcher, [&] {
+    m_decodingPool.parallelFor(blocks.size(), [&](size_t i) {
+      errors[i] = decodeBlock(blocks[i], maxBlockBlobSize, maxTxSize, span.blocks[i]);
+    });
+  });
+  decoding.get();
 
-  for (const block_complete_entry& block_entry : blocks) {
+  for (const std::string& error : errors) {
+    if (!error.empty()) {
+      logger(Logging::ERROR) << context << "sent wrong block: " << error << "\r\n dropping connection";
+      context.m_state = TycheCashConnectionContext::state_shutdown;
+      return false;
+    }
+  }
+
+  std::vector<const Block*> decodedBlocks;
+  decodedBlocks.reserve(span.blocks.size());
+  for (const DownloadedBlock& block : span.blocks) {
+    decodedBlocks.push_back(&block.block);
+  }
+
+  System::RemoteContext<void> hashing(m_dispatcher, [&] {
+    m_core.precomputeProofOfWork(decodedBlocks);
+  });
+  hashing.get();
+
+  return true;
+}
+
+void TycheCashProtocolHandler::applyParkedBlocks(const Crypto::Hash& previousBlockHash) {
+  assert(!m_applyingBlocks);
+  m_applyingBlocks = true;
+
+  {
+    m_core.pause_mining();
+
+    BOOST_SCOPE_EXIT_ALL(this) {
+      m_applyingBlocks = false;
+      m_core.update_block_template_and_resume_mining();
+    };
+
+    Crypto::Hash previous = previousBlockHash;
+    DownloadedSpan span;
+    while (!m_stop && m_downloadScheduler.takeNext(previous, span)) {
+      processObjects(span);
+      m_downloadScheduler.applied(span);
+      previous = span.blocks.back().hash;
+      if (!m_core.have_block(previous)) {
+        break;
+      }
+    }
+  }
+
+  uint32_t height;
+  Crypto::Hash top;
+  m_core.get_blockchain_top(height, top);
+  logger(DEBUGGING, BRIGHT_GREEN) << "Local blockchain updated, new height = " << height;
+
+  wakeWaitingConnections();
+}
+
+int TycheCashProtocolHandler::processObjects(const DownloadedSpan& span) {
+  for (const DownloadedBlock& downloadedBlock : span.blocks) {
     if (m_stop) {
       break;
     }
 
     //process transactions
-    for (auto& tx_blob : block_entry.txs) {
+    for (size_t i = 0; i < downloadedBlock.transactions.size(); ++i) {
       tx_verification_context tvc = boost::value_initialized<decltype(tvc)>();
-      m_core.handle_incoming_tx(asBinaryArray(tx_blob), tvc, true);
+      m_core.handleIncomingTransaction(downloadedBlock.transactions[i], downloadedBlock.transactionHashes[i], downloadedBlock.transactionSizes[i], tvc, true);
       if (tvc.m_verification_failed) {
-        logger(Logging::ERROR) << context << "transaction verification failed on NOTIFY_RESPONSE_GET_OBJECTS, \r\ntx_id = "
-          << Common::podToHex(getBinaryArrayHash(asBinaryArray(tx_blob))) << ", dropping connection";
-        context.m_state = TycheCashConnectionContext::state_shutdown;
+        updateConnection(span.connectionId, [&](TycheCashConnectionContext& context) {
+          logger(Logging::ERROR) << context << "transaction verification failed on NOTIFY_RESPONSE_GET_OBJECTS, \r\ntx_id = "
+            << Common::podToHex(downloadedBlock.transactionHashes[i]) << ", dropping connection";
+          context.m_state = TycheCashConnectionContext::state_shutdown;
+        });
+        m_downloadScheduler.dropParked();
         return 1;
       }
     }
 
     // process block
     block_verification_context bvc = boost::value_initialized<block_verification_context>();
-    m_core.handle_incoming_block_blob(asBinaryArray(block_entry.block), bvc, false, false);
+    m_core.handle_incoming_block(downloadedBlock.block, bvc, false, false);
 
     if (bvc.m_verification_failed) {
-      logger(Logging::DEBUGGING) << context << "Block verification failed, dropping connection";
-      context.m_state = TycheCashConnectionContext::state_shutdown;
+      updateConnection(span.connectionId, [&](TycheCashConnectionContext& context) {
+        logger(Logging::DEBUGGING) << context << "Block verification failed, dropping connection";
+        context.m_state = TycheCashConnectionContext::state_shutdown;
+      });
+      m_downloadScheduler.dropParked();
       return 1;
     } else if (bvc.m_marked_as_orphaned) {
-      logger(Logging::INFO) << context << "Block received at sync phase was marked as orphaned, dropping connection";
-      context.m_state = TycheCashConnectionContext::state_shutdown;
+      updateConnection(span.connectionId, [&](TycheCashConnectionContext& context) {
+        logger(Logging::INFO) << context << "Block received at sync phase was marked as orphaned, dropping connection";
+        context.m_state = TycheCashConnectionContext::state_shutdown;
+      });
+      m_downloadScheduler.dropParked();
       return 1;
     } else if (bvc.m_already_exists) {
-      logger(Logging::DEBUGGING) << context << "Block already exists, switching to idle state";
-      context.m_state = TycheCashConnectionContext::state_idle;
-      context.m_needed_objects.clear();
-      context.m_requested_objects.clear();
+      updateConnection(span.connectionId, [&](TycheCashConnectionContext& context) {
+        logger(Logging::DEBUGGING) << context << "Block already exists, switching to idle state";
+        context.m_state = TycheCashConnectionContext::state_idle;
+        context.m_needed_objects.clear();
+        context.m_requested_objects.clear();
+      });
+      m_downloadScheduler.release(span.connectionId);
       return 1;
     }
 
+    {
+      std::lock_guard<std::mutex> lock(m_syncSpeedMutex);
+      m_downloadScheduler.addAppliedBlocks(1);
+    }
+
     m_dispatcher.yield();
   }
 
   return 0;
+}
+
+void TycheCashProtocolHandler::wakeWaitingConnections() {
+  std::vector<boost::uuids::uuid> waiting = m_downloadScheduler.takeWaiting();
+  if (m_stop || waiting.empty()) {
+    return;
+  }
+
+  m_p2p->for_each_connection([&](TycheCashConnectionContext& context, PeerIdType peerId) {
+    if (context.m_state == TycheCashConnectionContext::state_synchronizing &&
+      std::find(waiting.begin(), waiting.end(), context.m_connection_id) != waiting.end()) {
+      request_missing_objects(context, true);
+    }
+  });
+}
 
+void TycheCashProtocolHandler::updateConnection(const boost::uuids::uuid& connectionId, const std::function<void(TycheCashConnectionContext&)>& update) {
+  m_p2p->for_each_connection([&](TycheCashConnectionContext& context, PeerIdType peerId) {
+    if (context.m_connection_id == connectionId) {
+      update(context);
+    }
+  });
 }
 
 
 bool TycheCashProtocolHandler::on_idle() {
+  // transactions which weren't delivered in time are requested from other peers which announced them
+  for (auto& item : m_transactionRequests.takeExpired()) {
+    updateConnection(item.first, [&](TycheCashConnectionContext& context) {
+      requestTransactions(item.second, context);
+    });
+  }
+
   return m_core.on_idle();
 }
 
@@ -470,19 +728,31 @@ int TycheCashProtocolHandler::handle_request_chain(int command, NOTIFY_REQUEST_C
 
 bool TycheCashProtocolHandler::request_missing_objects(TycheCashConnectionContext& context, bool check_having_blocks) {
   if (context.m_needed_objects.size()) {
+    if (!m_downloadScheduler.canReserve() && m_downloadScheduler.reservedBlocksCount() > 0) {
+      // too many blocks are waiting to be applied, continue when they are
+      m_downloadScheduler.addWaiting(context.m_connection_id);
+      return true;
+    }
+
     //we know objects that we need, request this objects
     NOTIFY_REQUEST_GET_OBJECTS::request req;
     size_t count = 0;
     auto it = context.m_needed_objects.begin();
 
     while (it != context.m_needed_objects.end() && count < BLOCKS_SYNCHRONIZING_DEFAULT_COUNT) {
-      if (!(check_having_blocks && m_core.have_block(*it))) {
+      //blocks requested from other connections are skipped
+      if (!(check_having_blocks && m_core.have_block(*it)) && m_downloadScheduler.reserve(*it, context.m_connection_id)) {
         req.blocks.push_back(*it);
         ++count;
         context.m_requested_objects.insert(*it);
       }
       it = context.m_needed_objects.erase(it);
     }
+
+    if (req.blocks.empty()) {
+      return request_missing_objects(context, check_having_blocks);
+    }
+
     logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_GET_OBJECTS: blocks.size()=" << req.blocks.size() << ", txs.size()=" << req.txs.size();
     post_notify<NOTIFY_REQUEST_GET_OBJECTS>(*m_p2p, req, context);
   } else if (context.m_last_response_height < context.m_remote_blockchain_height - 1) {//we have to fetch more objects ids, request blockchain entry
@@ -492,6 +762,17 @@ bool TycheCashProtocolHandler::request_missing_objects(TycheCashConnectionContex
     logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_CHAIN: m_block_ids.size()=" << r.block_ids.size();
     post_notify<NOTIFY_REQUEST_CHAIN>(*m_p2p, r, context);
   } else {
+    if (m_applyingBlocks || m_downloadScheduler.reservedBlocksCount() > 0) {
+      // the rest of the chain is being downloaded by other connections
+      m_downloadScheduler.addWaiting(context.m_connection_id);
+      return true;
+    }
+
+    if (m_downloadScheduler.parkedBlocksCount() > 0) {
+      logger(Logging::DEBUGGING) << context << "Dropping " << m_downloadScheduler.parkedBlocksCount() << " parked blocks which can't be applied";
+      m_downloadScheduler.dropParked();
+    }
+
     if (!(context.m_last_response_height ==
       context.m_remote_blockchain_height - 1 &&
       !context.m_needed_objects.size() &&
@@ -567,9 +848,19 @@ int TycheCashProtocolHandler::handle_response_chain_entry(int command, NOTIFY_RE
     context.m_state = TycheCashConnectionContext::state_shutdown;
   }
 
+  bool pending = false;
   for (auto& bl_id : arg.m_block_ids) {
-    if (!m_core.have_block(bl_id))
+    if (m_downloadScheduler.isPending(bl_id)) {
+      pending = true;
+    } else if (!m_core.have_block(bl_id)) {
       context.m_needed_objects.push_back(bl_id);
+    }
+  }
+
+  if (context.m_needed_objects.empty() && pending) {
+    // everything is downloaded by other connections, ask for the chain again after they make progress
+    m_downloadScheduler.addWaiting(context.m_connection_id);
+    return 1;
   }
 
   request_missing_objects(context, false);
@@ -587,7 +878,9 @@ int TycheCashProtocolHandler::handleRequestTxPool(int command, NOTIFY_REQUEST_TX
   if (!addedTransactions.empty()) {
     NOTIFY_NEW_TRANSACTIONS::request notification;
     for (auto& tx : addedTransactions) {
-      notification.txs.push_back(asString(toBinaryArray(tx)));
+      BinaryArray blob = toBinaryArray(tx);
+      context.m_knownTransactions.insert(getBinaryArrayHash(blob));
+      notification.txs.push_back(asString(blob));
     }
 
     bool ok = post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, notification, context);
@@ -606,8 +899,62 @@ void TycheCashProtocolHandler::relay_block(NOTIFY_NEW_BLOCK::request& arg) {
 }
 
 void TycheCashProtocolHandler::relay_transactions(NOTIFY_NEW_TRANSACTIONS::request& arg) {
-  auto buf = LevinProtocol::encode(arg);
-  m_p2p->externalRelayNotifyToAll(NOTIFY_NEW_TRANSACTIONS::ID, buf);
+  std::vector<Crypto::Hash> hashes;
+  for (const std::string& blob : arg.txs) {
+    hashes.push_back(getBinaryArrayHash(asBinaryArray(blob)));
+  }
+
+  // called from external threads, connections are accessed on the dispatcher thread only
+  std::vector<std::string> blobs = arg.txs;
+  m_dispatcher.remoteSpawn([this, hashes, blobs] {
+    relayTransactions(hashes, blobs, nullptr);
+  });
+}
+
+// Peers supporting P2PProtocolVersion::V2 get hashes of the transactions they don't know yet and request bodies they miss,
+// older peers get the bodies at once
+void TycheCashProtocolHandler::relayTransactions(const std::vector<Crypto::Hash>& hashes, const std::vector<std::string>& blobs, const net_connection_id* excludeConnection) {
+  assert(hashes.size() == blobs.size());
+
+  m_p2p->for_each_connection([&](TycheCashConnectionContext& context, PeerIdType peerId) {
+    if (peerId == 0 || (excludeConnection != nullptr && context.m_connection_id == *excludeConnection) ||
+        (context.m_state != TycheCashConnectionContext::state_normal && context.m_state != TycheCashConnectionContext::state_synchronizing)) {
+      return;
+    }
+
+    if (context.version >= P2PProtocolVersion::V2) {
+      NOTIFY_TX_INVENTORY::request notification;
+      for (const Crypto::Hash& hash : hashes) {
+        if (context.m_knownTransactions.insert(hash)) {
+          notification.txs.push_back(hash);
+        }
+      }
+
+      if (!notification.txs.empty()) {
+        post_notify<NOTIFY_TX_INVENTORY>(*m_p2p, notification, context);
+      }
+    } else {
+      NOTIFY_NEW_TRANSACTIONS::request notification;
+      for (size_t i = 0; i < hashes.size(); ++i) {
+        if (context.m_knownTransactions.insert(hashes[i])) {
+          notification.txs.push_back(blobs[i]);
+        }
+      }
+
+      if (!notification.txs.empty()) {
+        post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, notification, context);
+      }
+    }
+  });
+}
+
+void TycheCashProtocolHandler::requestTransactions(const std::vector<Crypto::Hash>& hashes, const TycheCashConnectionContext& context) {
+  NOTIFY_REQUEST_TXS::request request;
+  request.txs = hashes;
+  logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_TXS: txs.size() = " << request.txs.size();
+  if (!post_notify<NOTIFY_REQUEST_TXS>(*m_p2p, request, context)) {
+    logger(Logging::WARNING, Logging::BRIGHT_YELLOW) << "Failed to post notification NOTIFY_REQUEST_TXS to " << context.m_connection_id;
+  }
 }
 
 void TycheCashProtocolHandler::requestMissingPoolTransactions(const TycheCashConnectionContext& context) {
@@ -669,6 +1016,11 @@ void TycheCashProtocolHandler::recalculateMaxObservedHeight(const TycheCashConne
   m_observedHeight = std::max(peerHeight, localHeight + 1);
 }
 
+void TycheCashProtocolHandler::getSyncSpeed(double& blocksPerSecond, double& bytesPerSecond) const {
+  std::lock_guard<std::mutex> lock(m_syncSpeedMutex);
+  m_downloadScheduler.getSyncSpeed(blocksPerSecond, bytesPerSecond);
+}
+
 uint32_t TycheCashProtocolHandler::getObservedHeight() const {
   std::lock_guard<std::mutex> lock(m_observedHeightMutex);
   return m_observedHeight;
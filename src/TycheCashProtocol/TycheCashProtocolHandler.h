@@ -7,9 +7,12 @@
 #include <atomic>
 
 #include <Common/ObserverManager.h>
+#include <Common/ThreadPool.h>
 
 #include "TycheCashCore/ICore.h"
 
+#include "TycheCashProtocol/BlockDownloadScheduler.h"
+#include "TycheCashProtocol/TransactionInventory.h"
 #include "TycheCashProtocol/TycheCashProtocolDefinitions.h"
 #include "TycheCashProtocol/TycheCashProtocolHandlerCommon.h"
 #include "TycheCashProtocol/ITycheCashProtocolObserver.h"
@@ -57,6 +60,7 @@ namespace TycheCash
     int handleCommand(bool is_notify, int command, const BinaryArray& in_buff, BinaryArray& buff_out, TycheCashConnectionContext& context, bool& handled);
     virtual size_t getPeerCount() const override;
     virtual uint32_t getObservedHeight() const override;
+    virtual void getSyncSpeed(double& blocksPerSecond, double& bytesPerSecond) const override;
     void requestMissingPoolTransactions(const TycheCashConnectionContext& context);
 
   private:
@@ -68,6 +72,8 @@ namespace TycheCash
     int handle_request_chain(int command, NOTIFY_REQUEST_CHAIN::request& arg, TycheCashConnectionContext& context);
     int handle_response_chain_entry(int command, NOTIFY_RESPONSE_CHAIN_ENTRY::request& arg, TycheCashConnectionContext& context);
     int handleRequestTxPool(int command, NOTIFY_REQUEST_TX_POOL::request& arg, TycheCashConnectionContext& context);
+    int handleNotifyTxInventory(int command, NOTIFY_TX_INVENTORY::request& arg, TycheCashConnectionContext& context);
+    int handleRequestTxs(int command, NOTIFY_REQUEST_TXS::request& arg, TycheCashConnectionContext& context);
 
     //----------------- i_TycheCash_protocol ----------------------------------
     virtual void relay_block(NOTIFY_NEW_BLOCK::request& arg) override;
@@ -79,7 +85,13 @@ namespace TycheCash
     bool on_connection_synchronized();
     void updateObservedHeight(uint32_t peerHeight, const TycheCashConnectionContext& context);
     void recalculateMaxObservedHeight(const TycheCashConnectionContext& context);
-    int processObjects(TycheCashConnectionContext& context, const std::vector<block_complete_entry>& blocks);
+    bool decodeObjects(TycheCashConnectionContext& context, const std::vector<block_complete_entry>& blocks, DownloadedSpan& span);
+    void applyParkedBlocks(const Crypto::Hash& previousBlockHash);
+    int processObjects(const DownloadedSpan& span);
+    void wakeWaitingConnections();
+    void updateConnection(const boost::uuids::uuid& connectionId, const std::function<void(TycheCashConnectionContext&)>& update);
+    void relayTransactions(const std::vector<Crypto::Hash>& hashes, const std::vector<std::string>& blobs, const net_connection_id* excludeConnection);
+    void requestTransactions(const std::vector<Crypto::Hash>& hashes, const TycheCashConnectionContext& context);
     Logging::LoggerRef logger;
 
   private:
@@ -98,5 +110,11 @@ namespace TycheCash
 
     std::atomic<size_t> m_peersCount;
     Tools::ObserverManager<ITycheCashProtocolObserver> m_observerManager;
+
+    Tools::ThreadPool m_decodingPool;
+    BlockDownloadScheduler m_downloadScheduler;
+    mutable std::mutex m_syncSpeedMutex;
+    bool m_applyingBlocks;
+    TransactionRequests m_transactionRequests;
   };
 }
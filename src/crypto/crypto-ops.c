@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <assert.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "crypto-ops.h"
@@ -2893,3 +2894,41 @@ int sc_isnonzero(const unsigned char *s) {
     s[18] | s[19] | s[20] | s[21] | s[22] | s[23] | s[24] | s[25] | s[26] |
     s[27] | s[28] | s[29] | s[30] | s[31]) - 1) >> 8) + 1;
 }
+
+/*
+Same as ge_tobytes for count points, with a single field inversion shared by all of them
+(Montgomery's trick). tmp must have room for count field elements.
+Point i is written to s + 32 * i.
+*/
+
+void ge_tobytes_batch(unsigned char *s, const ge_p2 *h, fe *tmp, size_t count) {
+  fe recip;
+  fe zinv;
+  fe x;
+  fe y;
+  size_t i;
+
+  if (count == 0) {
+    return;
+  }
+
+  fe_copy(tmp[0], h[0].Z);
+  for (i = 1; i < count; ++i) {
+    fe_mul(tmp[i], tmp[i - 1], h[i].Z);
+  }
+
+  fe_invert(recip, tmp[count - 1]);
+  for (i = count - 1; i > 0; --i) {
+    fe_mul(zinv, recip, tmp[i - 1]); /* zinv = 1 / Z_i */
+    fe_mul(recip, recip, h[i].Z); /* recip = 1 / (Z_0 * ... * Z_{i-1}) */
+    fe_mul(x, h[i].X, zinv);
+    fe_mul(y, h[i].Y, zinv);
+    fe_tobytes(s + 32 * i, y);
+    s[32 * i + 31] ^= fe_isnegative(x) << 7;
+  }
+
+  fe_mul(x, h[0].X, recip);
+  fe_mul(y, h[0].Y, recip);
+  fe_tobytes(s, y);
+  s[31] ^= fe_isnegative(x) << 7;
+}
@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <alloca.h>
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -450,4 +451,70 @@ namespace Crypto {
     sc_sub(reinterpret_cast<unsigned char*>(&h), reinterpret_cast<unsigned char*>(&h), reinterpret_cast<unsigned char*>(&sum));
     return sc_isnonzero(reinterpret_cast<unsigned char*>(&h)) == 0;
   }
+
+  bool crypto_ops::check_ring_signatures(const RingSignatureBatchEntry *entries, size_t count) {
+    size_t i, j, k;
+    size_t points_count = 0;
+    size_t max_pubs_count = 0;
+    for (k = 0; k < count; k++) {
+      points_count += 2 * entries[k].pubs_count;
+      max_pubs_count = std::max(max_pubs_count, entries[k].pubs_count);
+    }
+
+    std::vector<ge_p2> points(points_count);
+    std::vector<EllipticCurvePoint> encoded(points_count);
+    std::unique_ptr<fe[]> tmp(new fe[points_count]);
+    std::unique_ptr<unsigned char[]> buf_data(new unsigned char[rs_comm_size(max_pubs_count)]);
+    rs_comm *const buf = reinterpret_cast<rs_comm *>(buf_data.get());
+
+    for (j = 0, k = 0; k < count; k++) {
+      const RingSignatureBatchEntry &entry = entries[k];
+      ge_p3 image_unp;
+      ge_dsmp image_pre;
+#if !defined(NDEBUG)
+      for (i = 0; i < entry.pubs_count; i++) {
+        assert(check_key(*entry.pubs[i]));
+      }
+#endif
+      if (ge_frombytes_vartime(&image_unp, reinterpret_cast<const unsigned char*>(entry.image)) != 0) {
+        return false;
+      }
+      ge_dsm_precomp(image_pre, &image_unp);
+      for (i = 0; i < entry.pubs_count; i++, j += 2) {
+        ge_p3 tmp3;
+        const unsigned char *c = reinterpret_cast<const unsigned char*>(&entry.sig[i]);
+        const unsigned char *r = reinterpret_cast<const unsigned char*>(&entry.sig[i]) + 32;
+        if (sc_check(c) != 0 || sc_check(r) != 0) {
+          return false;
+        }
+        if (ge_frombytes_vartime(&tmp3, reinterpret_cast<const unsigned char*>(&*entry.pubs[i])) != 0) {
+          abort();
+        }
+        ge_double_scalarmult_base_vartime(&points[j], c, &tmp3, r);
+        hash_to_ec(*entry.pubs[i], tmp3);
+        ge_double_scalarmult_precomp_vartime(&points[j + 1], r, &tmp3, c, image_pre);
+      }
+    }
+
+    ge_tobytes_batch(reinterpret_cast<unsigned char*>(encoded.data()), points.data(), tmp.get(), points_count);
+
+    for (j = 0, k = 0; k < count; k++) {
+      const RingSignatureBatchEntry &entry = entries[k];
+      EllipticCurveScalar sum, h;
+      sc_0(reinterpret_cast<unsigned char*>(&sum));
+      buf->h = *entry.prefix_hash;
+      for (i = 0; i < entry.pubs_count; i++, j += 2) {
+        buf->ab[i].a = encoded[j];
+        buf->ab[i].b = encoded[j + 1];
+        sc_add(reinterpret_cast<unsigned char*>(&sum), reinterpret_cast<unsigned char*>(&sum), reinterpret_cast<const unsigned char*>(&entry.sig[i]));
+      }
+      hash_to_scalar(buf, rs_comm_size(entry.pubs_count), h);
+      sc_sub(reinterpret_cast<unsigned char*>(&h), reinterpret_cast<unsigned char*>(&h), reinterpret_cast<unsigned char*>(&sum));
+      if (sc_isnonzero(reinterpret_cast<unsigned char*>(&h)) != 0) {
+        return false;
+      }
+    }
+
+    return true;
+  }
 }
@@ -31,6 +31,16 @@ struct EllipticCurveScalar {
   uint8_t data[32];
 };
 
+/* A ring signature to be checked by check_ring_signatures, arguments are the same as of check_ring_signature.
+ */
+struct RingSignatureBatchEntry {
+  const Hash *prefix_hash;
+  const KeyImage *image;
+  const PublicKey *const *pubs;
+  size_t pubs_count;
+  const Signature *sig;
+};
+
   class crypto_ops {
     crypto_ops();
     crypto_ops(const crypto_ops &);
@@ -81,6 +91,8 @@ struct EllipticCurveScalar {
       const PublicKey *const *, size_t, const Signature *);
     friend bool check_ring_signature(const Hash &, const KeyImage &,
       const PublicKey *const *, size_t, const Signature *);
+    static bool check_ring_signatures(const RingSignatureBatchEntry *, size_t);
+    friend bool check_ring_signatures(const RingSignatureBatchEntry *, size_t);
     friend bool validateKeyImage(const KeyImage& ki);
     static bool validateKeyImage(const KeyImage& ki);
   };
@@ -111,11 +123,11 @@ struct EllipticCurveScalar {
       return (std::numeric_limits<T>::max)();
     }
 #else
-    static T(min)() {
+    constexpr static T(min)() {
       return (std::numeric_limits<T>::min)();
     }
 
-    static T(max)() {
+    constexpr static T(max)() {
       return (std::numeric_limits<T>::max)();
     }
 #endif
@@ -244,6 +256,17 @@ struct EllipticCurveScalar {
     return check_ring_signature(prefix_hash, image, pubs.data(), pubs.size(), sig);
   }
 
+  /* Checks several ring signatures at once, e.g. all inputs of a block, returns true if all of them are valid.
+   * Faster than calling check_ring_signature for each of them, as commitment points of all ring members
+   * are converted to their byte representation with a single field inversion.
+   */
+  inline bool check_ring_signatures(const RingSignatureBatchEntry *entries, size_t count) {
+    return crypto_ops::check_ring_signatures(entries, count);
+  }
+  inline bool check_ring_signatures(const std::vector<RingSignatureBatchEntry> &entries) {
+    return check_ring_signatures(entries.data(), entries.size());
+  }
+
   inline bool validateKeyImage(const KeyImage& ki) {
     return crypto_ops::validateKeyImage(ki);
   }
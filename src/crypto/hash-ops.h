@@ -53,6 +53,10 @@ enum {
 void cn_fast_hash(const void *data, size_t length, char *hash);
 
 void cn_slow_hash_f(void *, const void *, size_t, void *);
+// Computes count slow hashes, several at once when AES-NI is available, every hash needs its own context
+void cn_slow_hash_multi_f(void *const *contexts, const void *const *data, const size_t *lengths, void *const *hashes, size_t count);
+// Number of hashes per cn_slow_hash_multi_f call which gives the best throughput on this CPU
+size_t cn_slow_hash_preferred_ways(void);
 
 void hash_extra_blake(const void *data, size_t length, char *hash);
 void hash_extra_groestl(const void *data, size_t length, char *hash);
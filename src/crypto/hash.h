@@ -32,6 +32,14 @@ namespace Crypto {
   class cn_context {
   public:
 
+    // How the scratchpad is backed. Random scratchpad reads miss TLB a lot with regular 4 KiB pages,
+    // so huge pages are tried first and regular pages are used when none can be obtained
+    enum PageMode {
+      HUGE_PAGES,
+      TRANSPARENT_HUGE_PAGES,
+      REGULAR_PAGES
+    };
+
     cn_context();
     ~cn_context();
 #if !defined(_MSC_VER) || _MSC_VER >= 1800
@@ -39,16 +47,42 @@ namespace Crypto {
     void operator=(const cn_context &) = delete;
 #endif
 
+    PageMode pageMode() const {
+      return mode;
+    }
+
+    static const char *pageModeName(PageMode mode);
+
   private:
 
     void *data;
+    size_t mapSize;
+    PageMode mode;
     friend inline void cn_slow_hash(cn_context &, const void *, size_t, Hash &);
+    friend inline void cn_slow_hash_multi(cn_context *const *, const void *const *, const size_t *, Hash *, size_t);
   };
 
   inline void cn_slow_hash(cn_context &context, const void *data, size_t length, Hash &hash) {
     (*cn_slow_hash_f)(context.data, data, length, reinterpret_cast<void *>(&hash));
   }
 
+  enum {
+    SLOW_HASH_MAX_WAYS = 4
+  };
+
+  // Computes count independent hashes, interleaving them to hide scratchpad access latency.
+  // contexts[i] must be distinct, count is at most SLOW_HASH_MAX_WAYS
+  inline void cn_slow_hash_multi(cn_context *const *contexts, const void *const *data, const size_t *lengths, Hash *hashes, size_t count) {
+    void *contextsData[SLOW_HASH_MAX_WAYS];
+    void *hashesData[SLOW_HASH_MAX_WAYS];
+    for (size_t i = 0; i < count; ++i) {
+      contextsData[i] = contexts[i]->data;
+      hashesData[i] = &hashes[i];
+    }
+
+    cn_slow_hash_multi_f(contextsData, data, lengths, hashesData, count);
+  }
+
   inline void tree_hash(const Hash *hashes, size_t count, Hash &root_hash) {
     tree_hash(reinterpret_cast<const char (*)[HASH_SIZE]>(hashes), count, reinterpret_cast<char *>(&root_hash));
   }
@@ -0,0 +1,172 @@
+// Copyright (c) 2017-2018 The TycheCash developers  ; Originally forked from Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// Computes WAYS independent hashes at once. The memory-hard loop is latency bound on scratchpad reads,
+// so steps of different hashes are interleaved to keep several reads in flight. Every hash uses its own context
+
+static void
+#if WAYS == 2
+cn_slow_hash_aesni_x2
+#elif WAYS == 4
+cn_slow_hash_aesni_x4
+#else
+#error Unsupported number of ways
+#endif
+(void *const *contexts, const void *const *data, const size_t *lengths, void *const *hashes)
+{
+  struct cn_ctx *ctx[WAYS];
+  ALIGNED_DECL(uint8_t ExpandedKey[WAYS][256], 16);
+  ALIGNED_DECL(uint64_t a[WAYS][2], 16);
+  __m128i b_x[WAYS];
+  size_t i, j, w;
+
+  for (w = 0; w < WAYS; w++)
+  {
+    __m128i *longoutput, *expkey, *xmminput;
+
+    ctx[w] = (struct cn_ctx *) contexts[w];
+    hash_process(&ctx[w]->state.hs, (const uint8_t*) data[w], lengths[w]);
+
+    memcpy(ctx[w]->text, ctx[w]->state.init, INIT_SIZE_BYTE);
+    memcpy(ExpandedKey[w], ctx[w]->state.hs.b, AES_KEY_SIZE);
+    ExpandAESKey256(ExpandedKey[w]);
+
+    longoutput = (__m128i *) ctx[w]->long_state;
+    expkey = (__m128i *) ExpandedKey[w];
+    xmminput = (__m128i *) ctx[w]->text;
+
+    for (i = 0; likely(i < MEMORY); i += INIT_SIZE_BYTE)
+    {
+      for (j = 0; j < 10; j++)
+      {
+        xmminput[0] = _mm_aesenc_si128(xmminput[0], expkey[j]);
+        xmminput[1] = _mm_aesenc_si128(xmminput[1], expkey[j]);
+        xmminput[2] = _mm_aesenc_si128(xmminput[2], expkey[j]);
+        xmminput[3] = _mm_aesenc_si128(xmminput[3], expkey[j]);
+        xmminput[4] = _mm_aesenc_si128(xmminput[4], expkey[j]);
+        xmminput[5] = _mm_aesenc_si128(xmminput[5], expkey[j]);
+        xmminput[6] = _mm_aesenc_si128(xmminput[6], expkey[j]);
+        xmminput[7] = _mm_aesenc_si128(xmminput[7], expkey[j]);
+      }
+
+      _mm_store_si128(&(longoutput[(i >> 4)]), xmminput[0]);
+      _mm_store_si128(&(longoutput[(i >> 4) + 1]), xmminput[1]);
+      _mm_store_si128(&(longoutput[(i >> 4) + 2]), xmminput[2]);
+      _mm_store_si128(&(longoutput[(i >> 4) + 3]), xmminput[3]);
+      _mm_store_si128(&(longoutput[(i >> 4) + 4]), xmminput[4]);
+      _mm_store_si128(&(longoutput[(i >> 4) + 5]), xmminput[5]);
+      _mm_store_si128(&(longoutput[(i >> 4) + 6]), xmminput[6]);
+      _mm_store_si128(&(longoutput[(i >> 4) + 7]), xmminput[7]);
+    }
+
+    a[w][0] = ((uint64_t *)ctx[w]->state.k)[0] ^ ((uint64_t *)ctx[w]->state.k)[4];
+    a[w][1] = ((uint64_t *)ctx[w]->state.k)[1] ^ ((uint64_t *)ctx[w]->state.k)[5];
+    ctx[w]->b[0] = ((uint64_t *)ctx[w]->state.k)[2] ^ ((uint64_t *)ctx[w]->state.k)[6];
+    ctx[w]->b[1] = ((uint64_t *)ctx[w]->state.k)[3] ^ ((uint64_t *)ctx[w]->state.k)[7];
+    b_x[w] = _mm_load_si128((__m128i *)ctx[w]->b);
+  }
+
+  {
+    // state of every hash lives in its own variables, so that steps of different hashes are independent
+#define DECLARE_STATE(w) \
+    uint8_t *long_state##w = ctx[w]->long_state; \
+    ALIGNED_DECL(uint64_t a##w[2], 16); \
+    __m128i b_x##w = b_x[w]; \
+    a##w[0] = a[w][0]; \
+    a##w[1] = a[w][1];
+
+#define STEP(w) \
+    { \
+      __m128i c_x = _mm_load_si128((__m128i *)&long_state##w[a##w[0] & 0x1FFFF0]); \
+      __m128i a_x = _mm_load_si128((__m128i *)a##w); \
+      ALIGNED_DECL(uint64_t c[2], 16); \
+      uint64_t b[2]; \
+      uint64_t *nextblock; \
+      uint64_t hi, lo; \
+      c_x = _mm_aesenc_si128(c_x, a_x); \
+      _mm_store_si128((__m128i *)c, c_x); \
+      b_x##w = _mm_xor_si128(b_x##w, c_x); \
+      _mm_store_si128((__m128i *)&long_state##w[a##w[0] & 0x1FFFF0], b_x##w); \
+      nextblock = (uint64_t *)&long_state##w[c[0] & 0x1FFFF0]; \
+      b[0] = nextblock[0]; \
+      b[1] = nextblock[1]; \
+      MUL128(c[0], b[0], hi, lo); \
+      a##w[0] += hi; \
+      a##w[1] += lo; \
+      nextblock[0] = a##w[0]; \
+      nextblock[1] = a##w[1]; \
+      a##w[0] ^= b[0]; \
+      a##w[1] ^= b[1]; \
+      b_x##w = c_x; \
+    }
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define MUL128(x, y, hi, lo) __asm__("mulq %3\n\t" : "=d" (hi), "=a" (lo) : "%a" (x), "rm" (y) : "cc")
+#else
+#define MUL128(x, y, hi, lo) lo = mul128(x, y, &hi)
+#endif
+
+    DECLARE_STATE(0)
+    DECLARE_STATE(1)
+#if WAYS == 4
+    DECLARE_STATE(2)
+    DECLARE_STATE(3)
+#endif
+
+    for (i = 0; likely(i < 0x80000); i++)
+    {
+      STEP(0)
+      STEP(1)
+#if WAYS == 4
+      STEP(2)
+      STEP(3)
+#endif
+    }
+
+#undef MUL128
+#undef STEP
+#undef DECLARE_STATE
+  }
+
+  for (w = 0; w < WAYS; w++)
+  {
+    __m128i *longoutput, *expkey, *xmminput;
+
+    memcpy(ctx[w]->text, ctx[w]->state.init, INIT_SIZE_BYTE);
+    memcpy(ExpandedKey[w], &ctx[w]->state.hs.b[32], AES_KEY_SIZE);
+    ExpandAESKey256(ExpandedKey[w]);
+
+    longoutput = (__m128i *) ctx[w]->long_state;
+    expkey = (__m128i *) ExpandedKey[w];
+    xmminput = (__m128i *) ctx[w]->text;
+
+    for (i = 0; likely(i < MEMORY); i += INIT_SIZE_BYTE)
+    {
+      xmminput[0] = _mm_xor_si128(longoutput[(i >> 4)], xmminput[0]);
+      xmminput[1] = _mm_xor_si128(longoutput[(i >> 4) + 1], xmminput[1]);
+      xmminput[2] = _mm_xor_si128(longoutput[(i >> 4) + 2], xmminput[2]);
+      xmminput[3] = _mm_xor_si128(longoutput[(i >> 4) + 3], xmminput[3]);
+      xmminput[4] = _mm_xor_si128(longoutput[(i >> 4) + 4], xmminput[4]);
+      xmminput[5] = _mm_xor_si128(longoutput[(i >> 4) + 5], xmminput[5]);
+      xmminput[6] = _mm_xor_si128(longoutput[(i >> 4) + 6], xmminput[6]);
+      xmminput[7] = _mm_xor_si128(longoutput[(i >> 4) + 7], xmminput[7]);
+
+      for (j = 0; j < 10; j++)
+      {
+        xmminput[0] = _mm_aesenc_si128(xmminput[0], expkey[j]);
+        xmminput[1] = _mm_aesenc_si128(xmminput[1], expkey[j]);
+        xmminput[2] = _mm_aesenc_si128(xmminput[2], expkey[j]);
+        xmminput[3] = _mm_aesenc_si128(xmminput[3], expkey[j]);
+        xmminput[4] = _mm_aesenc_si128(xmminput[4], expkey[j]);
+        xmminput[5] = _mm_aesenc_si128(xmminput[5], expkey[j]);
+        xmminput[6] = _mm_aesenc_si128(xmminput[6], expkey[j]);
+        xmminput[7] = _mm_aesenc_si128(xmminput[7], expkey[j]);
+      }
+    }
+
+    memcpy(ctx[w]->state.init, ctx[w]->text, INIT_SIZE_BYTE);
+    hash_permutation(&ctx[w]->state.hs);
+    extra_hashes[ctx[w]->state.hs.b[0] & 3](&ctx[w]->state, 200, hashes[w]);
+  }
+}
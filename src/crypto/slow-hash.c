@@ -22,11 +22,21 @@
 #include "oaes_lib.h"
 
 void (*cn_slow_hash_fp)(void *, const void *, size_t, void *);
+void (*cn_slow_hash_multi_fp)(void *const *, const void *const *, const size_t *, void *const *, size_t);
+size_t cn_slow_hash_ways = 1;
 
 void cn_slow_hash_f(void * a, const void * b, size_t c, void * d){
 (*cn_slow_hash_fp)(a, b, c, d);
 }
 
+void cn_slow_hash_multi_f(void *const *contexts, const void *const *data, const size_t *lengths, void *const *hashes, size_t count){
+(*cn_slow_hash_multi_fp)(contexts, data, lengths, hashes, count);
+}
+
+size_t cn_slow_hash_preferred_ways(void){
+return cn_slow_hash_ways;
+}
+
 #if defined(__GNUC__)
 #define likely(x) (__builtin_expect(!!(x), 1))
 #define unlikely(x) (__builtin_expect(!!(x), 0))
@@ -166,8 +176,70 @@ static void (*const extra_hashes[4])(const void *, size_t, char *) =
 #define AESNI
 #include "slow-hash.inl"
 
+#define WAYS 2
+#include "slow-hash-multi.inl"
+#undef WAYS
+#define WAYS 4
+#include "slow-hash-multi.inl"
+#undef WAYS
+
+static void cn_slow_hash_multi_aesni(void *const *contexts, const void *const *data, const size_t *lengths, void *const *hashes, size_t count)
+{
+  size_t i = 0;
+  for (; count - i >= 4; i += 4)
+  {
+    cn_slow_hash_aesni_x4(contexts + i, data + i, lengths + i, hashes + i);
+  }
+
+  if (count - i >= 2)
+  {
+    cn_slow_hash_aesni_x2(contexts + i, data + i, lengths + i, hashes + i);
+    i += 2;
+  }
+
+  if (i < count)
+  {
+    cn_slow_hash_aesni(contexts[i], data[i], lengths[i], hashes[i]);
+  }
+}
+
+static void cn_slow_hash_multi_noaesni(void *const *contexts, const void *const *data, const size_t *lengths, void *const *hashes, size_t count)
+{
+  size_t i;
+  for (i = 0; i < count; i++)
+  {
+    cn_slow_hash_noaesni(contexts[i], data[i], lengths[i], hashes[i]);
+  }
+}
+
+// Size of L2 cache of a core in bytes, zero if unknown
+static size_t detect_l2_size(void) {
+  unsigned int maxLeaf, ecx;
+#if defined(_MSC_VER)
+  int cpuinfo[4];
+  __cpuid(cpuinfo, 0x80000000);
+  maxLeaf = cpuinfo[0];
+  if (maxLeaf < 0x80000006) {
+    return 0;
+  }
+
+  __cpuid(cpuinfo, 0x80000006);
+  ecx = cpuinfo[2];
+#else
+  unsigned int a, b, d;
+  __cpuid(0x80000000, maxLeaf, b, ecx, d);
+  if (maxLeaf < 0x80000006) {
+    return 0;
+  }
+
+  __cpuid(0x80000006, a, b, ecx, d);
+#endif
+  return (size_t) (ecx >> 16) * 1024;
+}
+
 INITIALIZER(detect_aes) {
   int ecx;
+  size_t l2Size;
 #if defined(_MSC_VER)
   int cpuinfo[4];
   __cpuid(cpuinfo, 1);
@@ -176,5 +248,16 @@ INITIALIZER(detect_aes) {
   int a, b, d;
   __cpuid(1, a, b, ecx, d);
 #endif
-  cn_slow_hash_fp = (ecx & (1 << 25)) ? &cn_slow_hash_aesni : &cn_slow_hash_noaesni;
+  if (ecx & (1 << 25)) {
+    cn_slow_hash_fp = &cn_slow_hash_aesni;
+    cn_slow_hash_multi_fp = &cn_slow_hash_multi_aesni;
+    // When the scratchpad fits L2 alone, a second one pushes both to L3 and interleaving loses.
+    // Otherwise reads go to L3 anyway, and two hashes in flight hide its latency
+    l2Size = detect_l2_size();
+    cn_slow_hash_ways = (l2Size >= MEMORY && l2Size < 2 * MEMORY) ? 1 : 2;
+  } else {
+    cn_slow_hash_fp = &cn_slow_hash_noaesni;
+    cn_slow_hash_multi_fp = &cn_slow_hash_multi_noaesni;
+    cn_slow_hash_ways = 1;
+  }
 }
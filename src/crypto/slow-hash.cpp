@@ -9,7 +9,11 @@
 #if defined(WIN32)
 #include <Windows.h>
 #else
+#include <stdint.h>
 #include <sys/mman.h>
+#if defined(__APPLE__)
+#include <mach/vm_statistics.h>
+#endif
 #endif
 
 using std::bad_alloc;
@@ -17,12 +21,38 @@ using std::bad_alloc;
 namespace Crypto {
 
   enum {
-    MAP_SIZE = SLOW_HASH_CONTEXT_SIZE + ((-SLOW_HASH_CONTEXT_SIZE) & 0xfff)
+    MAP_SIZE = SLOW_HASH_CONTEXT_SIZE + ((-SLOW_HASH_CONTEXT_SIZE) & 0xfff),
+    HUGE_PAGE_SIZE = 1 << 21,
+    HUGE_MAP_SIZE = SLOW_HASH_CONTEXT_SIZE + ((-SLOW_HASH_CONTEXT_SIZE) & (HUGE_PAGE_SIZE - 1))
   };
 
+  const char *cn_context::pageModeName(PageMode mode) {
+    switch (mode) {
+    case HUGE_PAGES:
+      return "huge pages";
+    case TRANSPARENT_HUGE_PAGES:
+      return "transparent huge pages";
+    default:
+      return "regular pages";
+    }
+  }
+
 #if defined(WIN32)
 
   cn_context::cn_context() {
+    // large pages need SeLockMemoryPrivilege, without it the allocation fails
+    SIZE_T largePageSize = GetLargePageMinimum();
+    if (largePageSize != 0) {
+      mapSize = (MAP_SIZE + largePageSize - 1) & ~(largePageSize - 1);
+      data = VirtualAlloc(nullptr, mapSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+      if (data != nullptr) {
+        mode = HUGE_PAGES;
+        return;
+      }
+    }
+
+    mapSize = MAP_SIZE;
+    mode = REGULAR_PAGES;
     data = VirtualAlloc(nullptr, MAP_SIZE, MEM_COMMIT, PAGE_READWRITE);
     if (data == nullptr) {
       throw bad_alloc();
@@ -38,6 +68,44 @@ namespace Crypto {
 #else
 
   cn_context::cn_context() {
+#if defined(MAP_HUGETLB)
+    // succeeds only if huge pages are reserved, see /proc/sys/vm/nr_hugepages
+    data = mmap(nullptr, HUGE_MAP_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+    if (data != MAP_FAILED) {
+      mapSize = HUGE_MAP_SIZE;
+      mode = HUGE_PAGES;
+      return;
+    }
+#elif defined(__APPLE__)
+    data = mmap(nullptr, HUGE_MAP_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, VM_FLAGS_SUPERPAGE_SIZE_2MB, 0);
+    if (data != MAP_FAILED) {
+      mapSize = HUGE_MAP_SIZE;
+      mode = HUGE_PAGES;
+      return;
+    }
+#endif
+
+#if defined(MADV_HUGEPAGE)
+    // the scratchpad is aligned to a huge page boundary, so that the kernel can back it with a single huge page
+    void *region = mmap(nullptr, MAP_SIZE + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region != MAP_FAILED) {
+      uintptr_t begin = reinterpret_cast<uintptr_t>(region);
+      uintptr_t aligned = (begin + HUGE_PAGE_SIZE - 1) & ~static_cast<uintptr_t>(HUGE_PAGE_SIZE - 1);
+      if (aligned != begin) {
+        munmap(region, aligned - begin);
+      }
+
+      munmap(reinterpret_cast<void *>(aligned + MAP_SIZE), begin + HUGE_PAGE_SIZE - aligned);
+
+      data = reinterpret_cast<void *>(aligned);
+      mapSize = MAP_SIZE;
+      mode = madvise(data, MAP_SIZE, MADV_HUGEPAGE) == 0 ? TRANSPARENT_HUGE_PAGES : REGULAR_PAGES;
+      // populates the scratchpad, with huge pages if the kernel has them
+      mlock(data, MAP_SIZE);
+      return;
+    }
+#endif
+
 #if !defined(__APPLE__)
     data = mmap(nullptr, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
 #else
@@ -46,11 +114,13 @@ namespace Crypto {
     if (data == MAP_FAILED) {
       throw bad_alloc();
     }
+    mapSize = MAP_SIZE;
+    mode = REGULAR_PAGES;
     mlock(data, MAP_SIZE);
   }
 
   cn_context::~cn_context() {
-    if (munmap(data, MAP_SIZE) != 0) {
+    if (munmap(data, mapSize) != 0) {
       throw bad_alloc();
     }
   }
@@ -6,7 +6,9 @@
 #include <fstream>
 #include <iomanip>
 #include <ios>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "crypto/hash.h"
 #include "../Io.h"
@@ -41,6 +43,57 @@ struct hash_func {
   {"extra-blake", Crypto::hash_extra_blake}, {"extra-groestl", Crypto::hash_extra_groestl},
   {"extra-jh", Crypto::hash_extra_jh}, {"extra-skein", Crypto::hash_extra_skein}};
 
+// Every test vector is hashed together with the following ones, so that each of the interleaved hashes is checked
+static bool test_slow_multi(size_t ways, const char *path) {
+  fstream input;
+  vector<chash> expected;
+  vector<vector<char>> data;
+  input.open(path, ios_base::in);
+  for (;;) {
+    chash hash;
+    vector<char> item;
+    input.exceptions(ios_base::badbit);
+    get(input, hash);
+    if (input.rdstate() & ios_base::eofbit) {
+      break;
+    }
+    input.exceptions(ios_base::badbit | ios_base::failbit | ios_base::eofbit);
+    input.clear(input.rdstate());
+    get(input, item);
+    expected.push_back(hash);
+    data.push_back(item);
+  }
+
+  vector<unique_ptr<Crypto::cn_context>> contexts;
+  Crypto::cn_context *contextPointers[Crypto::SLOW_HASH_MAX_WAYS];
+  for (size_t i = 0; i < ways; i++) {
+    contexts.emplace_back(new Crypto::cn_context());
+    contextPointers[i] = contexts.back().get();
+  }
+
+  bool error = false;
+  for (size_t test = 0; test < data.size(); test++) {
+    const void *items[Crypto::SLOW_HASH_MAX_WAYS];
+    size_t lengths[Crypto::SLOW_HASH_MAX_WAYS];
+    chash actual[Crypto::SLOW_HASH_MAX_WAYS];
+    for (size_t i = 0; i < ways; i++) {
+      const vector<char> &item = data[(test + i) % data.size()];
+      items[i] = item.data();
+      lengths[i] = item.size();
+    }
+
+    Crypto::cn_slow_hash_multi(contextPointers, items, lengths, actual, ways);
+    for (size_t i = 0; i < ways; i++) {
+      if (actual[i] != expected[(test + i) % data.size()]) {
+        cerr << "Hash mismatch on test " << (test + i) % data.size() + 1 << " computed as hash " << i + 1 << " of " << ways << endl;
+        error = true;
+      }
+    }
+  }
+
+  return !error;
+}
+
 int main(int argc, char *argv[]) {
   hash_f *f;
   hash_func *hf;
@@ -53,6 +106,9 @@ int main(int argc, char *argv[]) {
     cerr << "Wrong number of arguments" << endl;
     return 1;
   }
+  if (argv[1] == string("slow-2") || argv[1] == string("slow-4")) {
+    return test_slow_multi(argv[1][5] - '0', argv[2]) ? 0 : 1;
+  }
   for (hf = hashes;; hf++) {
     if (hf >= &hashes[sizeof(hashes) / sizeof(hash_func)]) {
       cerr << "Unknown function" << endl;
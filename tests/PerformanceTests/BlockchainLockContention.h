@@ -0,0 +1,92 @@
+// Copyright (c) 2017-2018 The TycheCash developers  ; Originally forked from Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/RecursiveSharedMutex.h"
+
+// Readers take the lock the same way Blockchain query methods do
+struct recursive_mutex_lock {
+  typedef std::recursive_mutex mutex_type;
+
+  static void lock_reader(mutex_type& mutex) { mutex.lock(); }
+  static void unlock_reader(mutex_type& mutex) { mutex.unlock(); }
+};
+
+struct shared_mutex_lock {
+  typedef Tools::RecursiveSharedMutex mutex_type;
+
+  static void lock_reader(mutex_type& mutex) { mutex.lock_shared(); }
+  static void unlock_reader(mutex_type& mutex) { mutex.unlock_shared(); }
+};
+
+// Concurrent index lookups from 'thread_count' reader threads, while one more thread periodically
+// updates the index under exclusive lock, as block application does
+template<typename lock_policy, size_t thread_count>
+class test_blockchain_lock_contention {
+public:
+  static const size_t loop_count = 10;
+  static const size_t lookups_per_thread = 200000;
+  static const size_t index_size = 100000;
+  static const size_t writes_count = 100;
+
+  bool init() {
+    for (uint64_t i = 0; i < index_size; ++i) {
+      m_index[i] = i * 2;
+    }
+
+    return true;
+  }
+
+  bool test() {
+    std::vector<std::thread> threads;
+    std::vector<uint64_t> sums(thread_count, 0);
+    for (size_t t = 0; t < thread_count; ++t) {
+      threads.emplace_back([this, t, &sums] {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < lookups_per_thread; ++i) {
+          lock_policy::lock_reader(m_mutex);
+          // nested lock, as in query methods calling each other
+          lock_policy::lock_reader(m_mutex);
+          auto it = m_index.find((i * 7919 + t) % index_size);
+          sum += it->second;
+          lock_policy::unlock_reader(m_mutex);
+          lock_policy::unlock_reader(m_mutex);
+        }
+
+        sums[t] = sum;
+      });
+    }
+
+    std::thread writer([this] {
+      for (size_t i = 0; i < writes_count; ++i) {
+        std::lock_guard<typename lock_policy::mutex_type> lk(m_mutex);
+        m_index[i % index_size] = i * 2;
+        std::this_thread::yield();
+      }
+    });
+
+    writer.join();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    uint64_t total = 0;
+    for (uint64_t sum : sums) {
+      total += sum;
+    }
+
+    return total != 0;
+  }
+
+private:
+  typename lock_policy::mutex_type m_mutex;
+  std::unordered_map<uint64_t, uint64_t> m_index;
+};
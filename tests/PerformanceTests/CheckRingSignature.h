@@ -15,7 +15,7 @@
 #include "MultiTransactionTestBase.h"
 
 template<size_t a_ring_size>
-class test_check_ring_signature : private multi_tx_test_base<a_ring_size>
+class test_check_ring_signature : protected multi_tx_test_base<a_ring_size>
 {
   static_assert(0 < a_ring_size, "ring_size must be greater than 0");
 
@@ -51,8 +51,37 @@ public:
     return Crypto::check_ring_signature(m_tx_prefix_hash, txin.keyImage, this->m_public_key_ptrs, ring_size, m_tx.signatures[0].data());
   }
 
-private:
+protected:
   TycheCash::AccountBase m_alice;
   TycheCash::Transaction m_tx;
   Crypto::Hash m_tx_prefix_hash;
 };
+
+// Checks the same signature batch_size times with a single check_ring_signatures call,
+// compare with batch_size times the result of test_check_ring_signature
+template<size_t a_ring_size, size_t batch_size>
+class test_check_ring_signatures : public test_check_ring_signature<a_ring_size>
+{
+public:
+  typedef test_check_ring_signature<a_ring_size> base_class;
+
+  bool init()
+  {
+    if (!base_class::init())
+      return false;
+
+    const TycheCash::KeyInput& txin = boost::get<TycheCash::KeyInput>(this->m_tx.inputs[0]);
+    Crypto::RingSignatureBatchEntry entry = { &this->m_tx_prefix_hash, &txin.keyImage, this->m_public_key_ptrs, a_ring_size, this->m_tx.signatures[0].data() };
+    m_entries.assign(batch_size, entry);
+
+    return true;
+  }
+
+  bool test()
+  {
+    return Crypto::check_ring_signatures(m_entries);
+  }
+
+private:
+  std::vector<Crypto::RingSignatureBatchEntry> m_entries;
+};
@@ -0,0 +1,193 @@
+// Copyright (c) 2017-2018 The TycheCash developers  ; Originally forked from Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "Common/JsonValue.h"
+#include "Common/MemoryInputStream.h"
+#include "Common/StreamTools.h"
+#include "crypto/crypto.h"
+#include "TycheCashProtocol/TycheCashProtocolDefinitions.h"
+#include "Serialization/JsonInputValueSerializer.h"
+#include "Serialization/KVBinaryCommon.h"
+#include "Serialization/KVBinaryInputStreamSerializer.h"
+#include "Serialization/SerializationTools.h"
+
+// Previous way of reading KV binary storage: the whole payload is loaded to a JsonValue document first
+namespace kv_dom {
+
+using Common::JsonValue;
+using namespace TycheCash;
+
+template <typename T>
+T readPod(Common::IInputStream& s) {
+  T v;
+  Common::read(s, &v, sizeof(T));
+  return v;
+}
+
+inline size_t readVarint(Common::IInputStream& s) {
+  uint8_t b = readPod<uint8_t>(s);
+  size_t bytesLeft = 0;
+  switch (b & PORTABLE_RAW_SIZE_MARK_MASK) {
+  case PORTABLE_RAW_SIZE_MARK_WORD: bytesLeft = 1; break;
+  case PORTABLE_RAW_SIZE_MARK_DWORD: bytesLeft = 3; break;
+  case PORTABLE_RAW_SIZE_MARK_INT64: bytesLeft = 7; break;
+  }
+
+  size_t value = b;
+  for (size_t i = 1; i <= bytesLeft; ++i) {
+    value |= static_cast<size_t>(readPod<uint8_t>(s)) << (i * 8);
+  }
+
+  return value >> 2;
+}
+
+JsonValue loadSection(Common::IInputStream& stream);
+
+inline JsonValue loadValue(Common::IInputStream& stream, uint8_t type) {
+  switch (type) {
+  case BIN_KV_SERIALIZE_TYPE_INT64:  return JsonValue(readPod<int64_t>(stream));
+  case BIN_KV_SERIALIZE_TYPE_INT32:  return JsonValue(static_cast<int64_t>(readPod<int32_t>(stream)));
+  case BIN_KV_SERIALIZE_TYPE_UINT64: return JsonValue(static_cast<int64_t>(readPod<uint64_t>(stream)));
+  case BIN_KV_SERIALIZE_TYPE_UINT32: return JsonValue(static_cast<int64_t>(readPod<uint32_t>(stream)));
+  case BIN_KV_SERIALIZE_TYPE_UINT8:  return JsonValue(static_cast<int64_t>(readPod<uint8_t>(stream)));
+  case BIN_KV_SERIALIZE_TYPE_STRING: {
+    std::string str(readVarint(stream), '\0');
+    if (!str.empty()) {
+      Common::read(stream, &str[0], str.size());
+    }
+
+    return JsonValue(str);
+  }
+  case BIN_KV_SERIALIZE_TYPE_OBJECT: return loadSection(stream);
+  default:
+    throw std::runtime_error("Unsupported data type");
+  }
+}
+
+inline JsonValue loadEntry(Common::IInputStream& stream) {
+  uint8_t type = readPod<uint8_t>(stream);
+  if ((type & BIN_KV_SERIALIZE_FLAG_ARRAY) == 0) {
+    return loadValue(stream, type);
+  }
+
+  JsonValue arr(JsonValue::ARRAY);
+  size_t count = readVarint(stream);
+  while (count--) {
+    arr.pushBack(loadValue(stream, type & ~BIN_KV_SERIALIZE_FLAG_ARRAY));
+  }
+
+  return arr;
+}
+
+inline JsonValue loadSection(Common::IInputStream& stream) {
+  JsonValue sec(JsonValue::OBJECT);
+  size_t count = readVarint(stream);
+  std::string name;
+  while (count--) {
+    name.resize(readPod<uint8_t>(stream));
+    if (!name.empty()) {
+      Common::read(stream, &name[0], name.size());
+    }
+
+    sec.insert(name, loadEntry(stream));
+  }
+
+  return sec;
+}
+
+// Strings are stored as is, while JsonInputValueSerializer expects binary blobs in hex
+class Serializer : public JsonInputValueSerializer {
+public:
+  Serializer(JsonValue&& value) : JsonInputValueSerializer(std::move(value)) {
+  }
+
+  virtual bool binary(void* value, size_t size, Common::StringView name) override {
+    std::string str;
+    if (!(*this)(str, name)) {
+      return false;
+    }
+
+    if (str.size() != size) {
+      throw std::runtime_error("Binary block size mismatch");
+    }
+
+    memcpy(value, str.data(), size);
+    return true;
+  }
+
+  virtual bool binary(std::string& value, Common::StringView name) override {
+    return (*this)(value, name);
+  }
+};
+
+}
+
+struct kv_dom_deserializer {
+  static bool load(const std::string& buffer, TycheCash::NOTIFY_RESPONSE_GET_OBJECTS::request& value) {
+    Common::MemoryInputStream stream(buffer.data(), buffer.size());
+    kv_dom::readPod<TycheCash::KVBinaryStorageBlockHeader>(stream);
+    kv_dom::Serializer serializer(kv_dom::loadSection(stream));
+    serialize(value, serializer);
+    return true;
+  }
+};
+
+struct kv_streaming_deserializer {
+  static bool load(const std::string& buffer, TycheCash::NOTIFY_RESPONSE_GET_OBJECTS::request& value) {
+    Common::MemoryInputStream stream(buffer.data(), buffer.size());
+    TycheCash::KVBinaryInputStreamSerializer serializer(stream);
+    serialize(value, serializer);
+    return true;
+  }
+};
+
+// Decoding of a NOTIFY_RESPONSE_GET_OBJECTS payload with 'block_count' blocks of 'tx_count' transactions each,
+// as received during synchronization
+template<typename deserializer, size_t block_count, size_t tx_count>
+class test_kv_binary_deserialization {
+public:
+  static const size_t loop_count = 100;
+  static const size_t block_size = 200;
+  static const size_t tx_size = 2000;
+
+  bool init() {
+    TycheCash::NOTIFY_RESPONSE_GET_OBJECTS::request response;
+    response.current_blockchain_height = 1000000;
+    for (size_t i = 0; i < block_count; ++i) {
+      TycheCash::block_complete_entry block;
+      block.block = randomString(block_size);
+      for (size_t j = 0; j < tx_count; ++j) {
+        block.txs.push_back(randomString(tx_size));
+      }
+
+      response.blocks.push_back(std::move(block));
+    }
+
+    m_buffer = TycheCash::storeToBinaryKeyValue(response);
+    return true;
+  }
+
+  bool test() {
+    TycheCash::NOTIFY_RESPONSE_GET_OBJECTS::request response;
+    if (!deserializer::load(m_buffer, response)) {
+      return false;
+    }
+
+    return response.blocks.size() == block_count && response.current_blockchain_height == 1000000;
+  }
+
+private:
+  static std::string randomString(size_t size) {
+    std::string result(size, '\0');
+    Crypto::generate_random_bytes(size, &result[0]);
+    return result;
+  }
+
+  std::string m_buffer;
+};
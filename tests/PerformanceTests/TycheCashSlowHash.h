@@ -39,8 +39,53 @@ public:
     return hash == m_expected_hash;
   }
 
+  bool check(const Crypto::Hash& hash) const {
+    return hash == m_expected_hash;
+  }
+
 private:
   data_t m_data;
   Crypto::Hash m_expected_hash;
   Crypto::cn_context m_context;
 };
+
+// Same number of hashes for every 'ways', so elapsed times compare hashing throughput directly
+template<size_t ways>
+class test_cn_slow_hash_multi {
+public:
+  static const size_t hash_count = 40;
+  static const size_t loop_count = hash_count / ways;
+
+  bool init() {
+    if (!m_single.init()) {
+      return false;
+    }
+
+    for (size_t i = 0; i < ways; ++i) {
+      m_contextPointers[i] = &m_contexts[i];
+      m_data[i] = "caveat emptor";
+      m_lengths[i] = 13;
+    }
+
+    return true;
+  }
+
+  bool test() {
+    Crypto::Hash hashes[ways];
+    Crypto::cn_slow_hash_multi(m_contextPointers, m_data, m_lengths, hashes, ways);
+    for (size_t i = 0; i < ways; ++i) {
+      if (!m_single.check(hashes[i])) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+private:
+  test_cn_slow_hash m_single;
+  Crypto::cn_context m_contexts[ways];
+  Crypto::cn_context* m_contextPointers[ways];
+  const void* m_data[ways];
+  size_t m_lengths[ways];
+};
@@ -6,6 +6,7 @@
 #include "PerformanceUtils.h"
 
 // tests
+#include "BlockchainLockContention.h"
 #include "ConstructTransaction.h"
 #include "CheckRingSignature.h"
 #include "TycheCashSlowHash.h"
@@ -15,9 +16,20 @@
 #include "GenerateKeyImage.h"
 #include "GenerateKeyImageHelper.h"
 #include "IsOutToAccount.h"
+#include "KVBinaryDeserialization.h"
 
 int main(int argc, char** argv)
 {
+  // Multithreaded tests go first, threads would inherit affinity to a single core otherwise
+  TEST_PERFORMANCE2(test_blockchain_lock_contention, recursive_mutex_lock, 1);
+  TEST_PERFORMANCE2(test_blockchain_lock_contention, recursive_mutex_lock, 2);
+  TEST_PERFORMANCE2(test_blockchain_lock_contention, recursive_mutex_lock, 4);
+  TEST_PERFORMANCE2(test_blockchain_lock_contention, recursive_mutex_lock, 8);
+  TEST_PERFORMANCE2(test_blockchain_lock_contention, shared_mutex_lock, 1);
+  TEST_PERFORMANCE2(test_blockchain_lock_contention, shared_mutex_lock, 2);
+  TEST_PERFORMANCE2(test_blockchain_lock_contention, shared_mutex_lock, 4);
+  TEST_PERFORMANCE2(test_blockchain_lock_contention, shared_mutex_lock, 8);
+
   set_process_affinity(1);
   set_thread_high_priority();
 
@@ -50,6 +62,15 @@ int main(int argc, char** argv)
   TEST_PERFORMANCE1(test_check_ring_signature, 10);
   TEST_PERFORMANCE1(test_check_ring_signature, 100);
 
+  TEST_PERFORMANCE2(test_check_ring_signatures, 1, 1);
+  TEST_PERFORMANCE2(test_check_ring_signatures, 2, 1);
+  TEST_PERFORMANCE2(test_check_ring_signatures, 10, 1);
+  TEST_PERFORMANCE2(test_check_ring_signatures, 100, 1);
+  TEST_PERFORMANCE2(test_check_ring_signatures, 1, 10);
+  TEST_PERFORMANCE2(test_check_ring_signatures, 2, 10);
+  TEST_PERFORMANCE2(test_check_ring_signatures, 10, 10);
+  TEST_PERFORMANCE2(test_check_ring_signatures, 100, 10);
+
   TEST_PERFORMANCE0(test_is_out_to_acc);
   TEST_PERFORMANCE0(test_generate_key_image_helper);
   TEST_PERFORMANCE0(test_generate_key_derivation);
@@ -58,6 +79,14 @@ int main(int argc, char** argv)
   TEST_PERFORMANCE0(test_derive_secret_key);
 
   TEST_PERFORMANCE0(test_cn_slow_hash);
+  TEST_PERFORMANCE1(test_cn_slow_hash_multi, 1);
+  TEST_PERFORMANCE1(test_cn_slow_hash_multi, 2);
+  TEST_PERFORMANCE1(test_cn_slow_hash_multi, 4);
+
+  TEST_PERFORMANCE3(test_kv_binary_deserialization, kv_dom_deserializer, 10, 1);
+  TEST_PERFORMANCE3(test_kv_binary_deserialization, kv_streaming_deserializer, 10, 1);
+  TEST_PERFORMANCE3(test_kv_binary_deserialization, kv_dom_deserializer, 128, 10);
+  TEST_PERFORMANCE3(test_kv_binary_deserialization, kv_streaming_deserializer, 128, 10);
 
   std::cout << "Tests finished. Elapsed time: " << timer.elapsed_ms() / 1000 << " sec" << std::endl;
 
@@ -262,6 +262,59 @@ TEST_F(TcpConnectionTests, sendBigChunk) {
   ASSERT_EQ(buf, incoming);
 }
 
+TEST_F(TcpConnectionTests, sendBigChunkInSeveralBuffers) {
+  connect();
+
+  const size_t bufsize = 5 * 1024 * 1024; // 5MB
+  std::vector<std::vector<uint8_t>> bufs(3, std::vector<uint8_t>(bufsize));
+  std::vector<uint8_t> expected;
+  for (auto& buf : bufs) {
+    fillRandomBuf(buf);
+    expected.insert(expected.end(), buf.begin(), buf.end());
+  }
+
+  std::vector<uint8_t> incoming;
+  Event readComplete(dispatcher);
+
+  contextGroup.spawn([&]{
+    uint8_t readBuf[1024];
+    size_t readSize;
+    while ((readSize = connection2.read(readBuf, sizeof(readBuf))) > 0) {
+      incoming.insert(incoming.end(), readBuf, readBuf + readSize);
+    }
+
+    readComplete.set();
+  });
+
+  contextGroup.spawn([&]{
+    std::vector<TcpConnection::Buffer> buffers;
+    for (auto& buf : bufs) {
+      buffers.push_back({ buf.data(), buf.size() });
+    }
+
+    size_t first = 0;
+    while (first < buffers.size()) {
+      auto transferred = connection1.writeBuffers(&buffers[first], buffers.size() - first);
+      while (transferred > 0 && transferred >= buffers[first].size) {
+        transferred -= buffers[first].size;
+        ++first;
+      }
+
+      if (transferred > 0) {
+        buffers[first].data += transferred;
+        buffers[first].size -= transferred;
+      }
+    }
+
+    connection1 = TcpConnection(); // close connection
+  });
+
+  readComplete.wait();
+
+  ASSERT_EQ(expected.size(), incoming.size());
+  ASSERT_EQ(expected, incoming);
+}
+
 TEST_F(TcpConnectionTests, writeWhenReadWaiting) {
   connect();
 
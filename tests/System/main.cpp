@@ -2,9 +2,22 @@
 // Distributed under the MIT/X11 software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <cstdlib>
+#include <cstring>
 #include <gtest/gtest.h>
+#include <System/Dispatcher.h>
 
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
+#ifdef __linux__
+  // --dispatcher-threads=N runs every dispatcher created by the tests on N threads
+  const char* threadsOption = "--dispatcher-threads=";
+  for (int i = 1; i < argc; ++i) {
+    if (strncmp(argv[i], threadsOption, strlen(threadsOption)) == 0) {
+      System::Dispatcher::setDefaultThreadCount(static_cast<size_t>(std::atoi(argv[i] + strlen(threadsOption))));
+    }
+  }
+#endif
+
   return RUN_ALL_TESTS();
 }
@@ -0,0 +1,141 @@
+// Copyright (c) 2017-2018 The TycheCash developers  ; Originally forked from Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+
+#include "TycheCashProtocol/BlockDownloadScheduler.h"
+
+using namespace TycheCash;
+
+namespace {
+
+Crypto::Hash hashOf(uint8_t value) {
+  Crypto::Hash hash = Crypto::Hash();
+  hash.data[0] = value;
+  return hash;
+}
+
+boost::uuids::uuid connection(uint8_t value) {
+  boost::uuids::uuid id = boost::uuids::uuid();
+  id.data[0] = value;
+  return id;
+}
+
+// span of blocks [first, first + count), block i is built on block i - 1
+DownloadedSpan span(uint8_t first, uint8_t count, const boost::uuids::uuid& connectionId) {
+  DownloadedSpan result;
+  result.connectionId = connectionId;
+  for (uint8_t i = first; i < first + count; ++i) {
+    DownloadedBlock block;
+    block.block.previousBlockHash = hashOf(i - 1);
+    block.hash = hashOf(i);
+    result.blocks.push_back(block);
+  }
+
+  return result;
+}
+
+}
+
+TEST(BlockDownloadScheduler, blockIsReservedForOneConnection) {
+  BlockDownloadScheduler scheduler(100);
+  ASSERT_TRUE(scheduler.reserve(hashOf(1), connection(1)));
+  ASSERT_TRUE(scheduler.reserve(hashOf(1), connection(1)));
+  ASSERT_FALSE(scheduler.reserve(hashOf(1), connection(2)));
+  ASSERT_TRUE(scheduler.reserve(hashOf(2), connection(2)));
+  ASSERT_TRUE(scheduler.isPending(hashOf(1)));
+
+  scheduler.received(hashOf(1));
+  ASSERT_FALSE(scheduler.isPending(hashOf(1)));
+  ASSERT_TRUE(scheduler.reserve(hashOf(1), connection(2)));
+}
+
+TEST(BlockDownloadScheduler, releaseDropsReservationsOfConnection) {
+  BlockDownloadScheduler scheduler(100);
+  scheduler.reserve(hashOf(1), connection(1));
+  scheduler.reserve(hashOf(2), connection(1));
+  scheduler.reserve(hashOf(3), connection(2));
+
+  ASSERT_TRUE(scheduler.release(connection(1)));
+  ASSERT_FALSE(scheduler.release(connection(1)));
+  ASSERT_FALSE(scheduler.isPending(hashOf(1)));
+  ASSERT_FALSE(scheduler.isPending(hashOf(2)));
+  ASSERT_TRUE(scheduler.isPending(hashOf(3)));
+  ASSERT_TRUE(scheduler.hasPendingBlocks());
+  ASSERT_EQ(1, scheduler.reservedBlocksCount());
+
+  scheduler.release(connection(2));
+  ASSERT_FALSE(scheduler.hasPendingBlocks());
+}
+
+TEST(BlockDownloadScheduler, spansAreTakenInBlockchainOrder) {
+  BlockDownloadScheduler scheduler(100);
+  scheduler.park(span(21, 10, connection(3)));
+  scheduler.park(span(11, 10, connection(2)));
+  ASSERT_EQ(20, scheduler.parkedBlocksCount());
+  ASSERT_TRUE(scheduler.isPending(hashOf(15)));
+  ASSERT_FALSE(scheduler.reserve(hashOf(15), connection(1)));
+
+  DownloadedSpan next;
+  ASSERT_FALSE(scheduler.takeNext(hashOf(1), next));
+  ASSERT_TRUE(scheduler.takeNext(hashOf(10), next));
+  ASSERT_EQ(connection(2), next.connectionId);
+  ASSERT_EQ(hashOf(11), next.blocks.front().hash);
+
+  // blocks being applied can't be requested again
+  ASSERT_TRUE(scheduler.isPending(hashOf(15)));
+  ASSERT_EQ(20, scheduler.parkedBlocksCount());
+  scheduler.applied(next);
+  ASSERT_FALSE(scheduler.isPending(hashOf(15)));
+
+  ASSERT_TRUE(scheduler.takeNext(next.blocks.back().hash, next));
+  ASSERT_EQ(connection(3), next.connectionId);
+  scheduler.applied(next);
+  ASSERT_EQ(0, scheduler.parkedBlocksCount());
+  ASSERT_FALSE(scheduler.hasPendingBlocks());
+}
+
+TEST(BlockDownloadScheduler, parkedBlocksLimitReservations) {
+  BlockDownloadScheduler scheduler(10);
+  ASSERT_TRUE(scheduler.canReserve());
+  scheduler.park(span(1, 10, connection(1)));
+  ASSERT_FALSE(scheduler.canReserve());
+
+  scheduler.dropParked();
+  ASSERT_TRUE(scheduler.canReserve());
+  ASSERT_FALSE(scheduler.hasPendingBlocks());
+}
+
+TEST(BlockDownloadScheduler, waitingConnectionsAreTakenOnce) {
+  BlockDownloadScheduler scheduler(10);
+  scheduler.addWaiting(connection(1));
+  scheduler.addWaiting(connection(1));
+  scheduler.addWaiting(connection(2));
+  scheduler.release(connection(2));
+
+  std::vector<boost::uuids::uuid> waiting = scheduler.takeWaiting();
+  ASSERT_EQ(1, waiting.size());
+  ASSERT_EQ(connection(1), waiting.front());
+  ASSERT_TRUE(scheduler.takeWaiting().empty());
+}
+
+TEST(BlockDownloadScheduler, syncSpeedIsAveragedOverWindow) {
+  BlockDownloadScheduler scheduler(10);
+  BlockDownloadScheduler::Clock::time_point start = BlockDownloadScheduler::Clock::now();
+  const double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(BlockDownloadScheduler::SYNC_SPEED_WINDOW).count();
+
+  scheduler.addReceivedBytes(1000, start);
+  scheduler.addAppliedBlocks(10, start);
+  scheduler.addAppliedBlocks(10, start + std::chrono::seconds(1));
+
+  double blocksPerSecond;
+  double bytesPerSecond;
+  scheduler.getSyncSpeed(blocksPerSecond, bytesPerSecond, start + std::chrono::seconds(1));
+  ASSERT_DOUBLE_EQ(20 / seconds, blocksPerSecond);
+  ASSERT_DOUBLE_EQ(1000 / seconds, bytesPerSecond);
+
+  scheduler.getSyncSpeed(blocksPerSecond, bytesPerSecond, start + BlockDownloadScheduler::SYNC_SPEED_WINDOW + std::chrono::milliseconds(500));
+  ASSERT_DOUBLE_EQ(10 / seconds, blocksPerSecond);
+  ASSERT_DOUBLE_EQ(0, bytesPerSecond);
+}
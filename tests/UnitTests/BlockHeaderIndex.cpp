@@ -0,0 +1,129 @@
+// Copyright (c) 2017-2018 The TycheCash developers  ; Originally forked from Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+
+#include "Common/MemoryInputStream.h"
+#include "Common/StringOutputStream.h"
+#include "Serialization/BinaryInputStreamSerializer.h"
+#include "Serialization/BinaryOutputStreamSerializer.h"
+#include "TycheCashCore/BlockHeaderIndex.h"
+
+using namespace TycheCash;
+
+namespace {
+
+BlockHeaderInfo header(uint32_t height) {
+  BlockHeaderInfo result;
+  result.hash = Crypto::Hash();
+  result.hash.data[0] = static_cast<uint8_t>(height);
+  result.hash.data[1] = static_cast<uint8_t>(height >> 8);
+  result.timestamp = 1000 + 10 * height;
+  result.cumulativeDifficulty = height * (height + 1) / 2;
+  result.blockCumulativeSize = 100 + height;
+  result.alreadyGeneratedCoins = 1000000 * height;
+  result.headerSize = 80 + height % 3;
+  result.transactionCount = 1 + height % 5;
+  return result;
+}
+
+void fill(BlockHeaderIndex& index, uint32_t count) {
+  for (uint32_t height = index.size(); height < count; ++height) {
+    index.push(header(height));
+  }
+}
+
+void checkIndex(const BlockHeaderIndex& index, uint32_t size) {
+  ASSERT_EQ(size, index.size());
+  for (uint32_t height = 0; height < size; ++height) {
+    BlockHeaderInfo expected = header(height);
+    BlockHeaderInfo actual = index.get(height);
+    ASSERT_EQ(expected.hash, actual.hash);
+    ASSERT_EQ(expected.hash, index.hash(height));
+    ASSERT_EQ(expected.timestamp, index.timestamp(height));
+    ASSERT_EQ(expected.cumulativeDifficulty, index.cumulativeDifficulty(height));
+    ASSERT_EQ(expected.blockCumulativeSize, index.blockCumulativeSize(height));
+    ASSERT_EQ(expected.alreadyGeneratedCoins, index.alreadyGeneratedCoins(height));
+    ASSERT_EQ(expected.headerSize, index.headerSize(height));
+    ASSERT_EQ(expected.transactionCount, index.transactionCount(height));
+  }
+}
+
+}
+
+TEST(BlockHeaderIndex, pushPopAndResize) {
+  BlockHeaderIndex index;
+  ASSERT_TRUE(index.empty());
+
+  fill(index, 10);
+  checkIndex(index, 10);
+
+  index.pop();
+  checkIndex(index, 9);
+
+  index.resize(4);
+  checkIndex(index, 4);
+
+  fill(index, 6);
+  checkIndex(index, 6);
+
+  index.clear();
+  ASSERT_TRUE(index.empty());
+}
+
+TEST(BlockHeaderIndex, difficultyIsDifferenceOfCumulativeDifficulties) {
+  BlockHeaderIndex index;
+  fill(index, 5);
+  ASSERT_EQ(0, index.difficulty(0));
+  for (uint32_t height = 1; height < 5; ++height) {
+    ASSERT_EQ(height, index.difficulty(height));
+  }
+}
+
+TEST(BlockHeaderIndex, lowerBound) {
+  BlockHeaderIndex index;
+  fill(index, 10);
+
+  ASSERT_EQ(0, index.lowerBound(0, 0));
+  ASSERT_EQ(3, index.lowerBound(1030, 0));
+  ASSERT_EQ(4, index.lowerBound(1031, 0));
+  ASSERT_EQ(6, index.lowerBound(1030, 6));
+  ASSERT_EQ(10, index.lowerBound(1091, 0));
+}
+
+TEST(BlockHeaderIndex, serialization) {
+  BlockHeaderIndex index;
+  fill(index, 100);
+
+  std::string blob;
+  {
+    Common::StringOutputStream stream(blob);
+    BinaryOutputStreamSerializer s(stream);
+    index.serialize(s);
+  }
+
+  BlockHeaderIndex loaded;
+  Common::MemoryInputStream stream(blob.data(), blob.size());
+  BinaryInputStreamSerializer s(stream);
+  loaded.serialize(s);
+  checkIndex(loaded, 100);
+}
+
+TEST(BlockHeaderIndex, loadingOfUnknownVersionFails) {
+  BlockHeaderIndex index;
+  fill(index, 3);
+
+  std::string blob;
+  {
+    Common::StringOutputStream stream(blob);
+    BinaryOutputStreamSerializer s(stream);
+    index.serialize(s);
+  }
+
+  blob[0] = 100;
+  BlockHeaderIndex loaded;
+  Common::MemoryInputStream stream(blob.data(), blob.size());
+  BinaryInputStreamSerializer s(stream);
+  ASSERT_ANY_THROW(loaded.serialize(s));
+}
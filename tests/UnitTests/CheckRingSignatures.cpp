@@ -0,0 +1,87 @@
+// Copyright (c) 2017-2018 The TycheCash developers  ; Originally forked from Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "crypto/crypto.h"
+
+using namespace Crypto;
+
+namespace {
+
+struct SignedRing {
+  Hash prefixHash;
+  KeyImage image;
+  std::vector<PublicKey> keys;
+  std::vector<const PublicKey*> keyPtrs;
+  std::vector<Signature> signatures;
+
+  SignedRing(size_t ringSize, size_t realIndex) : keys(ringSize), keyPtrs(ringSize), signatures(ringSize) {
+    prefixHash = rand<Hash>();
+
+    SecretKey realSecretKey;
+    for (size_t i = 0; i < ringSize; ++i) {
+      SecretKey secretKey;
+      generate_keys(keys[i], secretKey);
+      keyPtrs[i] = &keys[i];
+      if (i == realIndex) {
+        realSecretKey = secretKey;
+      }
+    }
+
+    generate_key_image(keys[realIndex], realSecretKey, image);
+    generate_ring_signature(prefixHash, image, keyPtrs, realSecretKey, realIndex, signatures.data());
+  }
+
+  RingSignatureBatchEntry entry() const {
+    RingSignatureBatchEntry result = { &prefixHash, &image, keyPtrs.data(), keyPtrs.size(), signatures.data() };
+    return result;
+  }
+};
+
+}
+
+TEST(CheckRingSignatures, emptyBatchIsValid) {
+  ASSERT_TRUE(check_ring_signatures(std::vector<RingSignatureBatchEntry>()));
+}
+
+TEST(CheckRingSignatures, agreesWithCheckRingSignature) {
+  std::vector<SignedRing> rings;
+  for (size_t ringSize : { 1, 2, 3, 10 }) {
+    rings.emplace_back(ringSize, ringSize / 2);
+  }
+
+  std::vector<RingSignatureBatchEntry> entries;
+  for (const SignedRing& ring : rings) {
+    ASSERT_TRUE(check_ring_signature(ring.prefixHash, ring.image, ring.keyPtrs, ring.signatures.data()));
+    ASSERT_TRUE(check_ring_signatures(std::vector<RingSignatureBatchEntry>{ ring.entry() }));
+    entries.push_back(ring.entry());
+  }
+
+  ASSERT_TRUE(check_ring_signatures(entries));
+}
+
+TEST(CheckRingSignatures, failsIfAnySignatureIsWrong) {
+  std::vector<SignedRing> rings;
+  for (size_t i = 0; i < 4; ++i) {
+    rings.emplace_back(5, i);
+  }
+
+  std::vector<RingSignatureBatchEntry> entries;
+  for (const SignedRing& ring : rings) {
+    entries.push_back(ring.entry());
+  }
+
+  rings[2].prefixHash.data[0] ^= 1;
+  ASSERT_FALSE(check_ring_signature(rings[2].prefixHash, rings[2].image, rings[2].keyPtrs, rings[2].signatures.data()));
+  ASSERT_FALSE(check_ring_signatures(entries));
+
+  rings[2].prefixHash.data[0] ^= 1;
+  ASSERT_TRUE(check_ring_signatures(entries));
+
+  rings[3].signatures[1].data[40] ^= 1;
+  ASSERT_FALSE(check_ring_signatures(entries));
+}
@@ -244,6 +244,10 @@ bool ICoreStub::getAlreadyGeneratedCoins(const Crypto::Hash& hash, uint64_t& gen
   return true;
 }
 
+bool ICoreStub::getBlockHeaderInfo(uint32_t height, TycheCash::BlockHeaderInfo& header) {
+  return false;
+}
+
 bool ICoreStub::getBlockReward(size_t medianSize, size_t currentBlockSize, uint64_t alreadyGeneratedCoins, uint64_t fee,
     uint64_t& reward, int64_t& emissionChange) {
   return true;
@@ -316,6 +320,9 @@ bool ICoreStub::getTransactionsByPaymentId(const Crypto::Hash& paymentId, std::v
   return true;
 }
 
+void ICoreStub::precomputeProofOfWork(const std::vector<const TycheCash::Block*>& blocks) {
+}
+
 std::error_code ICoreStub::executeLocked(const std::function<std::error_code()>& func) {
   return func();
 }
@@ -332,10 +339,27 @@ bool ICoreStub::handleIncomingTransaction(const TycheCash::Transaction& tx, cons
   return poolTxVerificationResult;
 }
 
+void ICoreStub::handleIncomingTransactions(const std::vector<TycheCash::BinaryArray>& transactionBlobs, std::vector<TycheCash::tx_verification_context>& tvcs, bool keptByBlock) {
+  tvcs.assign(transactionBlobs.size(), boost::value_initialized<TycheCash::tx_verification_context>());
+  for (size_t i = 0; i < transactionBlobs.size(); ++i) {
+    TycheCash::Transaction tx;
+    if (!TycheCash::fromBinaryArray(tx, transactionBlobs[i])) {
+      tvcs[i].m_verification_failed = true;
+      continue;
+    }
+
+    handleIncomingTransaction(tx, TycheCash::getObjectHash(tx), transactionBlobs[i].size(), tvcs[i], keptByBlock);
+  }
+}
+
 bool ICoreStub::have_block(const Crypto::Hash& id) {
   return blocks.count(id) > 0;
 }
 
+bool ICoreStub::haveTransaction(const Crypto::Hash& id) {
+  return transactions.count(id) > 0 || transactionPool.count(id) > 0;
+}
+
 void ICoreStub::setPoolTxVerificationResult(bool result) {
   poolTxVerificationResult = result;
 }
@@ -41,6 +41,7 @@ public:
     uint32_t& start_height, uint32_t& current_height, uint32_t& full_offset, std::vector<TycheCash::BlockShortInfo>& entries) override;
 
   virtual bool have_block(const Crypto::Hash& id) override;
+  virtual bool haveTransaction(const Crypto::Hash& id) override;
   std::vector<Crypto::Hash> buildSparseChain() override;
   std::vector<Crypto::Hash> buildSparseChain(const Crypto::Hash& startBlockId) override;
   virtual bool get_stat_info(TycheCash::core_stat_info& st_inf) override { return false; }
@@ -48,6 +49,7 @@ public:
   virtual void pause_mining() override {}
   virtual void update_block_template_and_resume_mining() override {}
   virtual bool handle_incoming_block_blob(const TycheCash::BinaryArray& block_blob, TycheCash::block_verification_context& bvc, bool control_miner, bool relay_block) override { return false; }
+  virtual bool handle_incoming_block(const TycheCash::Block& b, TycheCash::block_verification_context& bvc, bool control_miner, bool relay_block) override { return false; }
   virtual bool handle_get_objects(TycheCash::NOTIFY_REQUEST_GET_OBJECTS::request& arg, TycheCash::NOTIFY_RESPONSE_GET_OBJECTS::request& rsp) override { return false; }
   virtual void on_synchronized() override {}
   virtual bool getOutByMSigGIndex(uint64_t amount, uint64_t gindex, TycheCash::MultisignatureOutput& out) override { return true; }
@@ -60,6 +62,7 @@ public:
   virtual bool getBackwardBlocksSizes(uint32_t fromHeight, std::vector<size_t>& sizes, size_t count) override;
   virtual bool getBlockSize(const Crypto::Hash& hash, size_t& size) override;
   virtual bool getAlreadyGeneratedCoins(const Crypto::Hash& hash, uint64_t& generatedCoins) override;
+  virtual bool getBlockHeaderInfo(uint32_t height, TycheCash::BlockHeaderInfo& header) override;
   virtual bool getBlockReward(size_t medianSize, size_t currentBlockSize, uint64_t alreadyGeneratedCoins, uint64_t fee,
       uint64_t& reward, int64_t& emissionChange) override;
   virtual bool scanOutputkeysForIndices(const TycheCash::KeyInput& txInToKey, std::list<std::pair<Crypto::Hash, size_t>>& outputReferences) override;
@@ -74,6 +77,8 @@ public:
   virtual bool getTransactionsByPaymentId(const Crypto::Hash& paymentId, std::vector<TycheCash::Transaction>& transactions) override;
   virtual std::unique_ptr<TycheCash::IBlock> getBlock(const Crypto::Hash& blockId) override;
   virtual bool handleIncomingTransaction(const TycheCash::Transaction& tx, const Crypto::Hash& txHash, size_t blobSize, TycheCash::tx_verification_context& tvc, bool keptByBlock) override;
+  virtual void handleIncomingTransactions(const std::vector<TycheCash::BinaryArray>& transactionBlobs, std::vector<TycheCash::tx_verification_context>& tvcs, bool keptByBlock) override;
+  virtual void precomputeProofOfWork(const std::vector<const TycheCash::Block*>& blocks) override;
   virtual std::error_code executeLocked(const std::function<std::error_code()>& func) override;
 
   virtual bool addMessageQueue(TycheCash::MessageQueue<TycheCash::BlockchainMessage>& messageQueuePtr) override;
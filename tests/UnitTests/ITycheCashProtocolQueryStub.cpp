@@ -24,6 +24,11 @@ bool ITycheCashProtocolQueryStub::isSynchronized() const {
   return synchronized;
 }
 
+void ITycheCashProtocolQueryStub::getSyncSpeed(double& blocksPerSecond, double& bytesPerSecond) const {
+  blocksPerSecond = 0;
+  bytesPerSecond = 0;
+}
+
 void ITycheCashProtocolQueryStub::setPeerCount(uint32_t count) {
   peers = count;
 }
@@ -18,6 +18,7 @@ public:
   virtual uint32_t getObservedHeight() const override;
   virtual size_t getPeerCount() const override;
   virtual bool isSynchronized() const override;
+  virtual void getSyncSpeed(double& blocksPerSecond, double& bytesPerSecond) const override;
 
   void setPeerCount(uint32_t count);
   void setObservedHeight(uint32_t height);
@@ -0,0 +1,107 @@
+// Copyright (c) 2017-2018 The TycheCash developers  ; Originally forked from Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+#include "Common/RecursiveSharedMutex.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+using namespace Tools;
+
+TEST(RecursiveSharedMutex, readersShareLock) {
+  RecursiveSharedMutex mutex;
+  SharedLockGuard<RecursiveSharedMutex> lk(mutex);
+
+  auto otherReader = std::async(std::launch::async, [&mutex] {
+    SharedLockGuard<RecursiveSharedMutex> lk(mutex);
+    return true;
+  });
+
+  ASSERT_EQ(std::future_status::ready, otherReader.wait_for(std::chrono::seconds(5)));
+  ASSERT_TRUE(otherReader.get());
+}
+
+TEST(RecursiveSharedMutex, exclusiveLockIsRecursive) {
+  RecursiveSharedMutex mutex;
+  std::lock_guard<RecursiveSharedMutex> lk1(mutex);
+  std::lock_guard<RecursiveSharedMutex> lk2(mutex);
+  SharedLockGuard<RecursiveSharedMutex> lk3(mutex);
+}
+
+TEST(RecursiveSharedMutex, writerWaitsForReaders) {
+  RecursiveSharedMutex mutex;
+  std::atomic<bool> written(false);
+  std::future<void> writer;
+
+  {
+    SharedLockGuard<RecursiveSharedMutex> lk(mutex);
+    writer = std::async(std::launch::async, [&mutex, &written] {
+      std::lock_guard<RecursiveSharedMutex> lk(mutex);
+      written = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_FALSE(written);
+  }
+
+  ASSERT_EQ(std::future_status::ready, writer.wait_for(std::chrono::seconds(5)));
+  ASSERT_TRUE(written);
+}
+
+TEST(RecursiveSharedMutex, nestedReaderIsNotBlockedByWaitingWriter) {
+  RecursiveSharedMutex mutex;
+  std::future<void> writer;
+
+  {
+    SharedLockGuard<RecursiveSharedMutex> lk(mutex);
+    writer = std::async(std::launch::async, [&mutex] {
+      std::lock_guard<RecursiveSharedMutex> lk(mutex);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    // must not deadlock with the writer waiting for this thread
+    SharedLockGuard<RecursiveSharedMutex> nested(mutex);
+  }
+
+  ASSERT_EQ(std::future_status::ready, writer.wait_for(std::chrono::seconds(5)));
+}
+
+TEST(RecursiveSharedMutex, concurrentReadersAndWriters) {
+  RecursiveSharedMutex mutex;
+  uint64_t value = 0;
+  std::atomic<bool> consistent(true);
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      for (size_t i = 0; i < 10000; ++i) {
+        SharedLockGuard<RecursiveSharedMutex> lk(mutex);
+        if (value % 2 != 0) {
+          consistent = false;
+        }
+      }
+    });
+  }
+
+  for (size_t t = 0; t < 2; ++t) {
+    threads.emplace_back([&] {
+      for (size_t i = 0; i < 1000; ++i) {
+        std::lock_guard<RecursiveSharedMutex> lk(mutex);
+        ++value;
+        ++value;
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_TRUE(consistent);
+  ASSERT_EQ(4000, value);
+}
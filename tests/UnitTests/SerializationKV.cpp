@@ -6,6 +6,7 @@
 
 #include <boost/lexical_cast.hpp>
 
+#include "Common/StringOutputStream.h"
 #include "Serialization/KVBinaryInputStreamSerializer.h"
 #include "Serialization/KVBinaryOutputStreamSerializer.h"
 #include "Serialization/SerializationOverloads.h"
@@ -68,6 +69,22 @@ struct TestStruct {
 
 };
 
+// Same fields as TestStruct written in another order, with an extra field in the middle
+struct TestStructReordered {
+  TestStruct base;
+  TestElement extra;
+
+  void serialize(ISerializer& s) {
+    s(base.u64, "u64");
+    s(base.vec2, "vec2");
+    s(extra, "extra");
+    s(base.u8, "u8");
+    s(base.root, "root");
+    s(base.u32, "u32");
+    s(base.vec1, "vec1");
+  }
+};
+
 }
 
 
@@ -121,3 +138,72 @@ TEST(KVSerialize, BigCollection) {
   ASSERT_TRUE(TycheCash::loadFromBinaryKeyValue(ts2, buf));
   EXPECT_EQ(ts1, ts2);
 }
+
+TEST(KVSerialize, DumpSizeMatchesDump) {
+  TestStruct ts;
+  ts.root.name = "hello";
+  ts.vec1.resize(0x10000 >> 2);
+
+  KVBinaryOutputStreamSerializer serializer;
+  serialize(ts, serializer);
+
+  std::string buf;
+  Common::StringOutputStream stream(buf);
+  serializer.dump(stream);
+  ASSERT_EQ(buf.size(), serializer.dumpSize());
+}
+
+TEST(KVSerialize, ReorderedAndUnknownFields) {
+  TestStructReordered ts1;
+  ts1.base.u8 = 100;
+  ts1.base.u32 = 0xff0000;
+  ts1.base.u64 = 1ULL << 60;
+  ts1.base.root.name = "hello";
+  ts1.base.root.u32array.resize(10, 7);
+
+  TestElement sample;
+  sample.nonce = 101;
+  sample.u32array.resize(3, 5);
+  ts1.base.vec1.resize(10, sample);
+  ts1.base.vec2.resize(3, sample);
+  ts1.extra = sample;
+
+  TestStruct ts2;
+  std::string buf = TycheCash::storeToBinaryKeyValue(ts1);
+  ASSERT_TRUE(TycheCash::loadFromBinaryKeyValue(ts2, buf));
+  EXPECT_EQ(ts1.base, ts2);
+}
+
+TEST(KVSerialize, MissingFieldsAreNotRead) {
+  TestElement element;
+  element.name = "hello";
+  element.nonce = 12345;
+
+  // empty arrays are not stored at all
+  TestStruct ts1;
+  ts1.u8 = 1;
+  ts1.u32 = 2;
+  ts1.u64 = 3;
+  ts1.root = element;
+  ts1.vec2.resize(2, element);
+
+  TestStruct ts2;
+  ts2.vec1.resize(1);
+  std::string buf = TycheCash::storeToBinaryKeyValue(ts1);
+  ASSERT_TRUE(TycheCash::loadFromBinaryKeyValue(ts2, buf));
+  EXPECT_EQ(ts1, ts2);
+}
+
+TEST(KVSerialize, TruncatedInputFails) {
+  TestStruct ts1;
+  ts1.u8 = 1;
+  ts1.u32 = 2;
+  ts1.u64 = 3;
+  ts1.root.name = "hello";
+
+  std::string buf = TycheCash::storeToBinaryKeyValue(ts1);
+  for (size_t size = 0; size < buf.size(); ++size) {
+    TestStruct ts2;
+    ASSERT_FALSE(TycheCash::loadFromBinaryKeyValue(ts2, buf.substr(0, size))) << "size " << size;
+  }
+}
@@ -0,0 +1,51 @@
+// Copyright (c) 2017-2018 The TycheCash developers  ; Originally forked from Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+#include "Common/ThreadPool.h"
+
+#include <atomic>
+#include <vector>
+
+using namespace Tools;
+
+TEST(ThreadPool, zeroMeansHardwareConcurrency) {
+  ThreadPool pool(0);
+  ASSERT_LE(1, pool.threadCount());
+}
+
+TEST(ThreadPool, parallelForCallsEveryIndexOnce) {
+  for (size_t threads : { 1, 2, 4 }) {
+    ThreadPool pool(threads);
+    ASSERT_EQ(threads, pool.threadCount());
+
+    std::vector<std::atomic<int>> calls(1000);
+    for (auto& c : calls) {
+      c = 0;
+    }
+
+    pool.parallelFor(calls.size(), [&calls](size_t i) { ++calls[i]; });
+
+    for (auto& c : calls) {
+      ASSERT_EQ(1, c);
+    }
+  }
+}
+
+TEST(ThreadPool, parallelForWithNoWork) {
+  ThreadPool pool(4);
+  bool called = false;
+  pool.parallelFor(0, [&called](size_t) { called = true; });
+  ASSERT_FALSE(called);
+}
+
+TEST(ThreadPool, parallelForCanBeCalledRepeatedly) {
+  ThreadPool pool(3);
+  std::atomic<size_t> sum(0);
+  for (size_t round = 0; round < 100; ++round) {
+    pool.parallelFor(10, [&sum](size_t i) { sum += i; });
+  }
+
+  ASSERT_EQ(100 * 45, sum);
+}
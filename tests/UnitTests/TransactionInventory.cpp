@@ -0,0 +1,103 @@
+// Copyright (c) 2017-2018 The TycheCash developers  ; Originally forked from Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <gtest/gtest.h>
+
+#include "TycheCashProtocol/TransactionInventory.h"
+
+using namespace TycheCash;
+
+namespace {
+
+const TransactionRequests::Clock::duration TIMEOUT = std::chrono::seconds(30);
+
+Crypto::Hash hashOf(uint8_t value) {
+  Crypto::Hash hash = Crypto::Hash();
+  hash.data[0] = value;
+  return hash;
+}
+
+boost::uuids::uuid connection(uint8_t value) {
+  boost::uuids::uuid id = boost::uuids::uuid();
+  id.data[0] = value;
+  return id;
+}
+
+}
+
+TEST(KnownInventory, insertReportsNewHashes) {
+  KnownInventory inventory(10);
+  ASSERT_TRUE(inventory.insert(hashOf(1)));
+  ASSERT_FALSE(inventory.insert(hashOf(1)));
+  ASSERT_TRUE(inventory.contains(hashOf(1)));
+  ASSERT_FALSE(inventory.contains(hashOf(2)));
+  ASSERT_EQ(1, inventory.size());
+}
+
+TEST(KnownInventory, oldestHashesAreForgotten) {
+  KnownInventory inventory(3);
+  for (uint8_t i = 1; i <= 5; ++i) {
+    inventory.insert(hashOf(i));
+  }
+
+  ASSERT_EQ(3, inventory.size());
+  ASSERT_FALSE(inventory.contains(hashOf(1)));
+  ASSERT_FALSE(inventory.contains(hashOf(2)));
+  ASSERT_TRUE(inventory.contains(hashOf(3)));
+  ASSERT_TRUE(inventory.contains(hashOf(5)));
+}
+
+TEST(TransactionRequests, transactionIsRequestedFromFirstAnnouncerOnly) {
+  TransactionRequests requests(TIMEOUT);
+  TransactionRequests::Clock::time_point now = TransactionRequests::Clock::now();
+
+  ASSERT_TRUE(requests.announced(hashOf(1), connection(1), now));
+  ASSERT_FALSE(requests.announced(hashOf(1), connection(2), now));
+  ASSERT_FALSE(requests.announced(hashOf(1), connection(1), now));
+  ASSERT_TRUE(requests.takeExpired(now + TIMEOUT / 2).empty());
+
+  requests.received(hashOf(1));
+  ASSERT_EQ(0, requests.size());
+  ASSERT_TRUE(requests.announced(hashOf(1), connection(2), now));
+}
+
+TEST(TransactionRequests, expiredRequestMovesToNextAnnouncer) {
+  TransactionRequests requests(TIMEOUT);
+  TransactionRequests::Clock::time_point now = TransactionRequests::Clock::now();
+
+  requests.announced(hashOf(1), connection(1), now);
+  requests.announced(hashOf(1), connection(2), now);
+  requests.announced(hashOf(1), connection(3), now);
+
+  auto expired = requests.takeExpired(now + TIMEOUT);
+  ASSERT_EQ(1, expired.size());
+  ASSERT_EQ(std::vector<Crypto::Hash>{ hashOf(1) }, expired[connection(2)]);
+
+  expired = requests.takeExpired(now + 2 * TIMEOUT);
+  ASSERT_EQ(std::vector<Crypto::Hash>{ hashOf(1) }, expired[connection(3)]);
+
+  // nobody else announced it
+  ASSERT_TRUE(requests.takeExpired(now + 3 * TIMEOUT).empty());
+  ASSERT_EQ(0, requests.size());
+}
+
+TEST(TransactionRequests, requestsOfClosedConnectionExpireAtOnce) {
+  TransactionRequests requests(TIMEOUT);
+  TransactionRequests::Clock::time_point now = TransactionRequests::Clock::now();
+
+  requests.announced(hashOf(1), connection(1), now);
+  requests.announced(hashOf(1), connection(2), now);
+  requests.announced(hashOf(2), connection(2), now);
+  requests.announced(hashOf(2), connection(1), now);
+
+  requests.release(connection(1));
+  auto expired = requests.takeExpired(now);
+  ASSERT_EQ(1, expired.size());
+  ASSERT_EQ(std::vector<Crypto::Hash>{ hashOf(1) }, expired[connection(2)]);
+
+  // connection 1 is not an announcer of the second transaction anymore
+  requests.release(connection(2));
+  ASSERT_TRUE(requests.takeExpired(now).empty());
+  ASSERT_EQ(0, requests.size());
+}
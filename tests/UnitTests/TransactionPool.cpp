@@ -32,6 +32,11 @@ class TransactionValidator : public TycheCash::ITransactionValidator {
     return true;
   }
 
+  virtual void checkTransactionsInputs(const std::vector<const TycheCash::Transaction*>& transactions, std::vector<BlockInfo>& maxUsedBlocks, std::vector<bool>& valid) override {
+    maxUsedBlocks.resize(transactions.size());
+    valid.assign(transactions.size(), true);
+  }
+
   virtual bool haveSpentKeyImages(const TycheCash::Transaction& tx) override {
     return false;
   }
@@ -258,6 +263,33 @@ TEST_F(tx_pool, double_spend_tx)
   ASSERT_TRUE(tvc.m_verification_failed);
 }
 
+TEST_F(tx_pool, add_txs_rejects_double_spend_within_batch)
+{
+  TxTestBase test(1);
+  std::vector<Transaction> txs(2);
+
+  test.construct(test.m_currency.minimumFee(), 1, txs[0]);
+  test.txGenerator.rv_acc.generate(); // generate new receiver address
+  test.construct(test.m_currency.minimumFee(), 1, txs[1]);
+
+  std::vector<Crypto::Hash> ids;
+  std::vector<size_t> blobSizes;
+  for (const Transaction& tx : txs) {
+    ids.push_back(getObjectHash(tx));
+    blobSizes.push_back(getObjectBinarySize(tx));
+  }
+
+  std::vector<tx_verification_context> tvcs;
+  test.pool.add_txs(txs, ids, blobSizes, tvcs, false);
+
+  ASSERT_EQ(2, tvcs.size());
+  ASSERT_TRUE(tvcs[0].m_added_to_pool);
+  ASSERT_FALSE(tvcs[0].m_verification_failed);
+  ASSERT_FALSE(tvcs[1].m_added_to_pool);
+  ASSERT_TRUE(tvcs[1].m_verification_failed);
+  ASSERT_EQ(1, test.pool.get_transactions_count());
+}
+
 
 TEST_F(tx_pool, fillblock_same_fee)
 {
@@ -241,6 +241,15 @@ int main(int argc, char *argv[]) {
       if (expected != actual) {
         goto error;
       }
+      {
+        const Crypto::RingSignatureBatchEntry entries[2] = {
+          { &prefix_hash, &image, pubs.data(), pubs_count, sigs.data() },
+          { &prefix_hash, &image, pubs.data(), pubs_count, sigs.data() }
+        };
+        if (check_ring_signatures(entries, 1) != expected || check_ring_signatures(entries, 2) != expected) {
+          goto error;
+        }
+      }
     } else {
       throw ios_base::failure("Unknown function: " + cmd);
     }